@@ -14,7 +14,7 @@
 namespace db {
 
 void DB::ExecuteQuery([[maybe_unused]] Transaction &txn, const std::string &query) {
-	assert(catalog_ && bpm_ && "meta manager and buffer pool manager must be initialized");
+	assert(catalog_ && buffer_pools_ && "meta manager and buffer pools must be initialized");
 	hsql::SQLParserResult raw_parse_result;
 	hsql::SQLParser::parse(query, &raw_parse_result);
 	if (!raw_parse_result.isValid()) {
@@ -31,9 +31,9 @@ void DB::ExecuteQuery([[maybe_unused]] Transaction &txn, const std::string &quer
 			auto planner = Planner {*catalog_};
 			planner.PlanQuery(*bound_stmt);
 			std::vector<Tuple> result_set;
-			auto context = ExecutorContext {*catalog_, *bpm_};
+			auto context = ExecutorContext {*catalog_, *buffer_pools_};
 			execution_engine_->Execute(std::move(planner.plan_), result_set, txn, context);
-			bpm_->FlushAllPages();
+			// dirty pages are written by the background writer and on shutdown
 			catalog_->PersistToDisk();
 			continue;
 		}
@@ -67,7 +67,8 @@ void DB::HandleCreateStatement([[maybe_unused]] Transaction &txn, const CreateSt
 		    std::ranges::find_if(schema.GetColumns(), [&](const Column &col) { return col.GetName() == primary_key; });
 		assert(key_col_it != schema.GetColumns().end() && "Broken invariant pk col not found");
 		const auto index_oid =
-		    catalog_->CreateIndex(table_name + "_pk", table_name, *key_col_it, true, IndexType::BPlusTreeIndex, *bpm_);
+		    catalog_->CreateIndex(table_name + "_pk", table_name, *key_col_it, true, IndexType::BPlusTreeIndex,
+		                          *buffer_pools_);
 		if (!index_oid.has_value()) {
 			throw RuntimeException("Failed to create primary key index");
 		}
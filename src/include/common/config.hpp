@@ -8,10 +8,38 @@
 namespace db {
 static constexpr page_id_t INVALID_PAGE_ID = -1; // invalid page id
 static constexpr table_oid_t INVALID_TABLE_OID = -1;
+static constexpr frame_id_t INVALID_FRAME_ID = -1;
 static constexpr uint32_t PAGE_SIZE = 4096; // size of a data page in byte
 const std::string DEFAULT_DB_NAME = "gavindb";
-static constexpr uint32_t DEFAULT_POOL_SIZE = 10;
+// names of the buffer pools, objects whose pool is not configured use the default one
+const std::string DEFAULT_BUFFER_POOL = "default";
+const std::string HEAP_BUFFER_POOL = "heap";
+const std::string INDEX_BUFFER_POOL = "index";
+const std::string TEMP_BUFFER_POOL = "temp";
+static constexpr uint32_t DEFAULT_POOL_SIZE = 1024; // frames of the buffer pool unless DBOptions says otherwise
+static constexpr uint32_t BUFFER_POOL_MIN_SHARD_SIZE = 64; // min frames per shard when picking the shard count
+static constexpr uint32_t BUFFER_POOL_RESIZE_TIMEOUT_MS = 1000; // a shrink keeps the frames still pinned after this
+static constexpr uint32_t BACKGROUND_WRITER_INTERVAL_MS = 200;       // sleep between two background writer rounds
+static constexpr uint32_t BACKGROUND_WRITER_MAX_PAGES_PER_ROUND = 100; // pages written per background writer round
+static constexpr uint32_t BACKGROUND_WRITER_DIRTY_PAGE_WATERMARK = 256; // dirty pages that wake the writer early
+static constexpr uint32_t BULK_READ_RING_SIZE = 32; // frames a large sequential scan cycles through
+static constexpr uint32_t BULK_READ_POOL_FRACTION = 4; // scans over more than 1/n of the pool use a ring
+static constexpr uint32_t READ_AHEAD_PAGES = 16; // pages a sequential scan reads ahead of its cursor
+// frames the ring of a scan keeps in every shard at least, a full read-ahead window may hash to a single shard
+static constexpr uint32_t BULK_READ_MIN_SHARD_RING_SIZE = READ_AHEAD_PAGES;
+static constexpr uint32_t WARM_RESTART_BATCH_PAGES = 64; // adjacent pages reloaded with one read on a warm restart
+static constexpr uint32_t OPTIMISTIC_READ_RETRIES = 4; // looks at a write latched page before an optimistic read fails
+static constexpr uint32_t BTREE_OPTIMISTIC_SEARCH_RESTARTS = 8; // restarts before a search falls back to crabbing
+static constexpr uint32_t TABLE_FILE_EXTENT_SIZE = 1 << 20; // bytes a table file is preallocated by when it grows
+static constexpr uint32_t MAX_OPEN_TABLE_FILES = 512; // table data files the disk manager keeps open at most
+static constexpr uint32_t TABLESPACE_EXTENT_PAGES = 64; // pages of a table kept together in the single-file layout
+static constexpr uint32_t FLUSH_BATCH_PAGES = 64; // dirty pages written back with one batch of vectored writes
+static constexpr uint32_t IO_URING_QUEUE_DEPTH = 64; // requests of a batch the io_uring engine keeps in flight
+static constexpr uint32_t IO_URING_NUM_RINGS = 4;    // rings shared by the threads submitting io
+static constexpr uint32_t LRU_K_REPLACER_K = 2; // number of accesses tracked per frame by the lru-k replacer
 static constexpr uint32_t INDEX_KEY_SIZE = 8;
+// bound on the children of a b+tree internal node, sizes the swizzled child references of a frame
+static constexpr uint32_t BTREE_MAX_CHILDREN = PAGE_SIZE / (INDEX_KEY_SIZE + sizeof(page_id_t));
 static constexpr uint32_t VARCHAR_DEFAULT_LENGTH = 128; // default length for varchar when constructing the column
 static constexpr table_oid_t SYSTEM_CATALOG_ID = -1;
 static constexpr timestamp_t INVALID_TS = -1;
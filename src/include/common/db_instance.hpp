@@ -6,22 +6,93 @@
 #include "meta/catalog.hpp"
 #include "query/binder/statement/create_statement.hpp"
 #include "query/execution_engine.hpp"
-#include "storage/buffer/buffer_pool.hpp"
+#include "storage/buffer/buffer_pool_set.hpp"
 
 #include <memory>
 #include <string>
+#include <vector>
 namespace db {
 
+struct DBOptions {
+	// number of frames the default buffer pool starts with
+	frame_id_t buffer_pool_size_ = DEFAULT_POOL_SIZE;
+	// upper bound for ResizeBufferPool, 0 keeps the pool at buffer_pool_size_
+	frame_id_t max_buffer_pool_size_ = 0;
+	// backs the buffer frames with transparent huge pages
+	bool use_huge_pages_ = false;
+	// IO_URING keeps the reads of a batch in flight together, it needs liburing at build time and falls back to
+	// blocking io otherwise
+	IoEngineType io_engine_ = IoEngineType::SYNC;
+	// TABLESPACE keeps the pages of all tables in one file, a database is opened with the layout it was created with
+	StorageLayout storage_layout_ = StorageLayout::FILE_PER_TABLE;
+	// bytes a table file is preallocated by when a write reaches past its reserved space, 0 disables preallocation
+	size_t table_file_extent_size_ = TABLE_FILE_EXTENT_SIZE;
+	// table files kept open at most, 0 leaves them open until shutdown
+	size_t max_open_files_ = MAX_OPEN_TABLE_FILES;
+	// o_direct table files, the buffer pool is then the only cache of the pages
+	bool direct_io_ = false;
+	// pacing of the writers that clean the dirty pages of every pool in the background
+	BackgroundWriterConfig background_writer_;
+	// saves the resident pages on shutdown and reloads them on startup
+	bool warm_restart_ = true;
+	// pools next to the default one, e.g. HEAP_BUFFER_POOL and INDEX_BUFFER_POOL to keep scans away from indexes
+	std::vector<BufferPoolConfig> buffer_pools_;
+};
+
 class DB {
 public:
-	explicit DB([[maybe_unused]] const std::string &db_file_name)
-	    : catalog_(std::make_unique<Catalog>()), disk_manager_(std::make_shared<DiskManager>(*catalog_)),
-	      bpm_(std::make_unique<BufferPool>(DEFAULT_POOL_SIZE, *disk_manager_)),
-	      execution_engine_(std::make_unique<ExecutionEngine>()), txn_manager_(std::make_unique<TransactionManager>()) {
-		      // DeletePathIfExists(db::FilePathManager::GetInstance().GetDatabaseRootPath());
-	      };
-	~DB() = default;
-	;
+	explicit DB([[maybe_unused]] const std::string &db_file_name, const DBOptions &options = {})
+	    : catalog_(std::make_unique<Catalog>(options.storage_layout_)),
+	      disk_manager_(std::make_shared<DiskManager>(
+	          *catalog_, DiskManagerConfig {options.storage_layout_, options.io_engine_,
+	                                        options.table_file_extent_size_, options.max_open_files_,
+	                                        options.direct_io_})),
+	      buffer_pools_(std::make_unique<BufferPoolSet>(
+	          *disk_manager_, BufferPoolConfig {DEFAULT_BUFFER_POOL, options.buffer_pool_size_,
+	                                            options.max_buffer_pool_size_, ReplacerType::LRU_K,
+	                                            options.use_huge_pages_})),
+	      warm_restart_(options.warm_restart_), execution_engine_(std::make_unique<ExecutionEngine>()),
+	      txn_manager_(std::make_unique<TransactionManager>()) {
+		// DeletePathIfExists(db::FilePathManager::GetInstance().GetDatabaseRootPath());
+		for (const auto &config : options.buffer_pools_) {
+			buffer_pools_->AddPool(config);
+		}
+		if (warm_restart_) {
+			buffer_pools_->LoadResidentPages();
+		}
+		buffer_pools_->StartBackgroundWriters(options.background_writer_);
+	};
+	~DB() {
+		try {
+			Close();
+		} catch (const std::exception &e) {
+			LOG_ERROR("Failed to write the dirty pages back on shutdown: {}", e.what());
+		}
+	}
+
+	// stops the background writers and writes every dirty page back. the destructor closes the DB as well but can
+	// only log a failed write, Close throws it. the DB is not used afterwards
+	void Close() {
+		if (closed_) {
+			return;
+		}
+		closed_ = true;
+		buffer_pools_->StopBackgroundWriters();
+		buffer_pools_->FlushAllPages();
+		if (warm_restart_) {
+			try {
+				buffer_pools_->SaveResidentPages();
+			} catch (const std::exception &e) {
+				LOG_WARN("Failed to save the resident pages: {}", e.what());
+			}
+		}
+	}
+
+	// frames are added or drained while queries keep running, returns the size the pool was resized to. frames that
+	// stay pinned for too long are kept
+	frame_id_t ResizeBufferPool(frame_id_t pool_size, const std::string &pool_name = DEFAULT_BUFFER_POOL) {
+		return buffer_pools_->GetExistingPool(pool_name).Resize(pool_size);
+	}
 
 	void HandleCreateStatement(Transaction &txn, const CreateStatement &stmt);
 	void ExecuteQuery([[maybe_unused]] Transaction &txn, const std::string &query);
@@ -31,7 +102,9 @@ private:
 
 	std::unique_ptr<Catalog> catalog_;
 	std::shared_ptr<DiskManager> disk_manager_;
-	std::unique_ptr<BufferPool> bpm_;
+	std::unique_ptr<BufferPoolSet> buffer_pools_;
+	bool warm_restart_;
+	bool closed_ {false};
 	std::unique_ptr<ExecutionEngine> execution_engine_;
 
 	/** Lock for Catalog */
@@ -4,6 +4,7 @@
 #include "common/typedef.hpp"
 #include "fmt/core.h"
 
+#include <cstdint>
 #include <functional>
 namespace db {
 
@@ -24,11 +25,28 @@ struct PageId {
 	[[nodiscard]] std::string ToString() const {
 		return fmt::format("PageId[{}, {}]", table_id_, page_number_);
 	}
+
+	// both halves in one 64 bit key, the table in the upper and the page number in the lower 32 bits
+	[[nodiscard]] uint64_t Pack() const {
+		return static_cast<uint64_t>(static_cast<uint32_t>(table_id_)) << 32 | static_cast<uint32_t>(page_number_);
+	}
+	[[nodiscard]] static PageId Unpack(uint64_t key) {
+		return {static_cast<table_oid_t>(key >> 32), static_cast<page_id_t>(static_cast<uint32_t>(key))};
+	}
 };
 
 struct PageIdHash {
 	std::size_t operator()(const PageId &page_id) const {
-		return page_id.table_id_ << 31 | page_id.page_number_;
+		return Mix(page_id.Pack());
+	}
+	// murmur3 finalizer, every bit of the packed key affects every bit of the hash
+	static uint64_t Mix(uint64_t hash) {
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ULL;
+		hash ^= hash >> 33;
+		return hash;
 	}
 };
 
@@ -1,14 +1,24 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <shared_mutex>
 
 namespace db {
+/**
+ * ReaderWriterLatch wraps a shared_mutex and a version counter for optimistic readers. The version is bumped when a
+ * writer takes the latch and again when it releases it, so an odd version means a writer is active. A reader that saw
+ * the same even version before and after looking at the protected data knows no writer got in between, without ever
+ * writing to the latch's cache line.
+ */
 class ReaderWriterLatch {
 public:
 	void WLock() {
 		mutex_.lock();
+		version_.fetch_add(1, std::memory_order_acq_rel);
 	}
 	void WUnlock() {
+		version_.fetch_add(1, std::memory_order_release);
 		mutex_.unlock();
 	}
 	void RLock() {
@@ -17,9 +27,34 @@ public:
 	void RUnlock() {
 		mutex_.unlock_shared();
 	}
+	bool TryRLock() {
+		return mutex_.try_lock_shared();
+	}
+	// bump the version like a writer without taking the mutex, for an owner that knows nobody can hold the latch.
+	// optimistic readers fail from BeginReplace until EndReplace
+	void BeginReplace() {
+		version_.fetch_add(1, std::memory_order_acq_rel);
+	}
+	void EndReplace() {
+		version_.fetch_add(1, std::memory_order_release);
+	}
+
+	[[nodiscard]] uint64_t GetVersion() const {
+		return version_.load(std::memory_order_acquire);
+	}
+	[[nodiscard]] static bool IsWriteLocked(uint64_t version) {
+		return (version & 1) != 0;
+	}
+	// true if no writer took the latch since version was read
+	[[nodiscard]] bool Validate(uint64_t version) const {
+		// keep the reads of the protected data from moving past the version check
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return version_.load(std::memory_order_relaxed) == version;
+	}
 
 private:
 	std::shared_mutex mutex_;
+	std::atomic<uint64_t> version_ {0};
 };
 
 } // namespace db
@@ -1,3 +1,8 @@
+#pragma once
+
+#include "meta/catalog.hpp"
+#include "storage/page_allocator.hpp"
+
 #include <array>
 #include <random>
 #include <string>
@@ -30,4 +35,24 @@ namespace db {
 
 	return random_string;
 }
+
+// hands out the next data page of the table, like the table heap does
+class TestPageAllocator : public PageAllocator {
+public:
+	explicit TestPageAllocator(TableMeta &table_meta) : table_meta_(table_meta) {
+	}
+	PageId AllocatePage() override {
+		return {table_meta_.table_oid_, table_meta_.IncrementTableDataPageId()};
+	}
+
+private:
+	TableMeta &table_meta_;
+};
+
+// a table with a single integer column
+inline TableMeta &CreateTestTable(Catalog &catalog, const std::string &table_name = "test_table") {
+	auto schema = Schema({Column("id", TypeId::INTEGER)});
+	catalog.CreateTable(table_name, schema);
+	return catalog.GetTableByName(table_name);
+}
 } // namespace db
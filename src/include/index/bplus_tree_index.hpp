@@ -11,6 +11,7 @@
 #include "storage/page/btree_leaf_page.hpp"
 #include "storage/page/page_guard.hpp"
 
+#include <atomic>
 #include <memory>
 namespace db {
 
@@ -33,8 +34,10 @@ class BTreeIndex : public Index {
 	enum class Operation { SEARCH, INSERT, DELETE };
 
 public:
-	BTreeIndex(IndexMeta &index_meta, TableMeta &table_meta, BufferPool &bpm)
-	    : Index(index_meta, table_meta), bpm_(bpm) {
+	// with swizzle_children set, every cached node keeps direct references to the frames of its children so a descent
+	// through cached nodes skips the page table lookups
+	BTreeIndex(IndexMeta &index_meta, TableMeta &table_meta, BufferPool &bpm, bool swizzle_children = false)
+	    : Index(index_meta, table_meta), bpm_(bpm), swizzle_children_(swizzle_children) {
 
 		LOG_TRACE("BTreeIndex constructor called");
 
@@ -57,14 +60,24 @@ public:
 
 protected:
 	bool InternalScanKey(const IndexKeyType key, std::vector<IndexValueType> &values) override {
+		bool tree_is_empty = false;
+		auto *leaf_raw_page = SearchLeafPageOptimistic(key, tree_is_empty);
+		if (tree_is_empty) {
+			return false;
+		}
+		if (leaf_raw_page == nullptr) {
+			// writers kept invalidating the optimistic descent, crab down with shared latches instead
+			auto &header_raw_page = FetchHeaderPage();
+			header_raw_page.RLatch();
+			// TODO lol
+			Transaction transaction {0, IsolationLevel::READ_COMMITTED};
+			leaf_raw_page = &SearchLeafPage(key, Operation::SEARCH, transaction, header_raw_page);
+		}
+		return LookupInLeaf(key, *leaf_raw_page, values);
+	}
 
-		auto &header_raw_page = bpm_.FetchPage({table_meta_.table_oid_, index_meta_.header_page_id_});
-		header_raw_page.RLatch();
-		// TODO lol
-		Transaction transaction {0, IsolationLevel::READ_COMMITTED};
-
-		auto &leaf_raw_page = SearchLeafPage(key, Operation::SEARCH, transaction, header_raw_page);
-
+	// expects the leaf to be pinned and read latched, releases both
+	bool LookupInLeaf(const IndexKeyType &key, Page &leaf_raw_page, std::vector<IndexValueType> &values) {
 		LOG_TRACE("Traversed to leaf page found with page id: {}", leaf_raw_page.GetPageId().page_number_);
 
 		const auto &leaf_page = leaf_raw_page.As<BtreeLeafPage>();
@@ -75,7 +88,7 @@ protected:
 		auto value = leaf_page.Lookup(key, comparator_);
 
 		leaf_raw_page.RUnlatch();
-		bpm_.UnpinPage(leaf_raw_page.GetPageId(), false);
+		bpm_.UnpinPage(leaf_raw_page, false);
 
 		if (!value.has_value()) {
 			return false;
@@ -90,7 +103,7 @@ protected:
 	// create node L'
 	bool InternalInsertRecord(Transaction &txn, const IndexKeyType key, const IndexValueType value) override {
 		// latch the root page
-		auto &header_raw_page = bpm_.FetchPage({table_meta_.table_oid_, index_meta_.header_page_id_});
+		auto &header_raw_page = FetchHeaderPage();
 		header_raw_page.WLatch();
 		LOG_TRACE("Adding header page id {} into page set (header)", header_raw_page.GetPageId().page_number_);
 		txn.AddIntoPageSet(header_raw_page);
@@ -134,7 +147,7 @@ protected:
 			InsertIntoParent(leaf_node, sibling_leaf_node, risen_key, transaction, header_page);
 
 			leaf_page.WUnlatch();
-			bpm_.UnpinPage(leaf_page.GetPageId(), true);
+			bpm_.UnpinPage(leaf_page, true);
 			bpm_.UnpinPage({table_meta_.table_oid_, sibling_leaf_node.GetPageId()}, true);
 
 			return true;
@@ -145,12 +158,12 @@ protected:
 		// don't need to split, release parent write latches one more time and do other clean up
 		ReleaseParentWriteLatches(transaction);
 		leaf_page.WUnlatch();
-		bpm_.UnpinPage(leaf_page.GetPageId(), true);
+		bpm_.UnpinPage(leaf_page, true);
 
 		return new_size != size;
 	}
 	bool InternalDeleteRecord(Transaction &txn, const IndexKeyType key) override {
-		auto &header_raw_page = bpm_.FetchPage({table_meta_.table_oid_, index_meta_.header_page_id_});
+		auto &header_raw_page = FetchHeaderPage();
 		header_raw_page.WLatch();
 		LOG_TRACE("Adding header page id {} into page set (header)", header_raw_page.GetPageId().page_number_);
 		txn.AddIntoPageSet(header_raw_page);
@@ -211,7 +224,7 @@ protected:
 			parent_internal_node.InsertNodeAfter(original_node.GetPageId(), key, sibling_new_node.GetPageId());
 
 			ReleaseParentWriteLatches(transaction);
-			bpm_.UnpinPage(parent_page.GetPageId(), true);
+			bpm_.UnpinPage(parent_page, true);
 			return;
 		}
 		// parent don't have space now have to split the parent internal node
@@ -238,7 +251,7 @@ protected:
 		LOG_TRACE("new parent %s", parent_internal_node.ToString().c_str());
 		LOG_TRACE("new sibling %s", parent_new_sibling_node.ToString().c_str());
 		InsertIntoParent(parent_internal_node, parent_new_sibling_node, new_key, transaction, header_page);
-		bpm_.UnpinPage(parent_page.GetPageId(), true);
+		bpm_.UnpinPage(parent_page, true);
 		bpm_.UnpinPage({table_meta_.table_oid_, parent_new_sibling_node.GetPageId()}, true);
 	}
 
@@ -269,19 +282,75 @@ protected:
 		return new_node;
 	}
 
+	// descends to the leaf for key without pinning or latching the header and internal pages. every node is read in
+	// its frame and validated before anything read from it is used, and the parent is validated again once the child
+	// was looked at so a concurrent split cannot send the search down a stale path. only the leaf is pinned and read
+	// latched. returns the pinned and latched leaf, or nullptr if writers forced BTREE_OPTIMISTIC_SEARCH_RESTARTS
+	// restarts
+	Page *SearchLeafPageOptimistic(const IndexKeyType &key, bool &tree_is_empty) {
+		for (uint32_t restart = 0; restart < BTREE_OPTIMISTIC_SEARCH_RESTARTS; ++restart) {
+			auto parent = FetchNodeOptimistic({table_meta_.table_oid_, index_meta_.header_page_id_}, HeaderRef());
+			const auto &header_node = parent.As<BtreeHeaderPage>();
+			tree_is_empty = header_node.TreeIsEmpty();
+			auto page_id = header_node.GetRootPageId();
+			if (!parent.Validate()) {
+				continue;
+			}
+			if (tree_is_empty) {
+				return nullptr;
+			}
+			auto *child_ref = ChildRef(parent.GetPage(), 0);
+			while (true) {
+				auto node = FetchNodeOptimistic({table_meta_.table_oid_, page_id}, child_ref);
+				const auto &btree_node = node.As<BtreePage>();
+				auto is_leaf = btree_node.IsLeafPage();
+				// a node read while it changes may hold any size, the slot lookup must not leave the page
+				auto size = btree_node.GetSize();
+				if (!parent.Validate() || !node.Validate()) {
+					break;
+				}
+				if (is_leaf) {
+					auto &leaf_page = FetchNode({table_meta_.table_oid_, page_id}, child_ref);
+					leaf_page.RLatch();
+					// the leaf is latched now, it is the right one if it did not change since it was looked at
+					if (leaf_page.GetVersion() == node.GetVersion()) {
+						return &leaf_page;
+					}
+					leaf_page.RUnlatch();
+					bpm_.UnpinPage(leaf_page, false);
+					break;
+				}
+				if (size == 0 || size > static_cast<idx_t>(INTERNAL_MAX_NODE_SIZE)) {
+					break;
+				}
+				const auto &internal_node = node.As<BtreeInternalPage>();
+				auto slot = internal_node.LookupSlot(key, comparator_);
+				page_id = internal_node.ValueAt(slot);
+				if (!node.Validate()) {
+					break;
+				}
+				assert(page_id > 0);
+				child_ref = ChildRef(node.GetPage(), slot);
+				parent = node;
+			}
+		}
+		return nullptr;
+	}
+
 	Page &SearchLeafPage(const IndexKeyType &key, Operation operation, Transaction &transaction, Page &header_page) {
 		// auto root_page_id = PageId {table_meta_.table_oid_, GetRootPageId()};
 
 		const auto &header_node = header_page.As<BtreeHeaderPage>();
 		auto root_page_id = header_node.GetRootPageId();
 		assert(root_page_id > 0);
-		auto *page = &bpm_.FetchPage({table_meta_.table_oid_, root_page_id});
+		auto *page = &FetchNode({table_meta_.table_oid_, root_page_id}, ChildRef(header_page, 0));
 		const auto *btree_node = &page->As<BtreePage>();
 		assert(page != nullptr);
 		// get latch on first node
 		if (operation == Operation::SEARCH) {
-			// unlatch the parent which is root
+			// unlatch and unpin the header, a search does not come back to it
 			header_page.RUnlatch();
+			bpm_.UnpinPage(header_page, false);
 			page->RLatch();
 		} else {
 			// for insert and delete
@@ -301,11 +370,12 @@ protected:
 			          static_cast<int>(internal_page.GetSize()), static_cast<int>(internal_page.GetParentPageId()),
 			          static_cast<int>(internal_page.GetMaxSize()), internal_page.ToString().c_str());
 
-			auto child_page_id = internal_page.Lookup(key, comparator_);
+			auto slot = internal_page.LookupSlot(key, comparator_);
+			auto child_page_id = internal_page.ValueAt(slot);
 			assert(child_page_id > 0);
 			LOG_TRACE("Search go to child: {}", child_page_id);
 			// move new page to node_pg should trigger the parent page to be released
-			auto *child_page = &bpm_.FetchPage({table_meta_.table_oid_, child_page_id});
+			auto *child_page = &FetchNode({table_meta_.table_oid_, child_page_id}, ChildRef(*page, slot));
 			assert(child_page != nullptr);
 			const auto *child_btree_node = &child_page->As<BtreePage>();
 
@@ -314,7 +384,7 @@ protected:
 				// unlatch parent and latch child
 				child_page->RLatch();
 				page->RUnlatch();
-				bpm_.UnpinPage(page->GetPageId(), false);
+				bpm_.UnpinPage(*page, false);
 			} else {
 				child_page->WLatch();
 				LOG_TRACE("Adding page id {} into page set", page->GetPageId().page_number_);
@@ -347,7 +417,8 @@ protected:
 		assert(operation != Operation::SEARCH);
 		// . because adding one more will not reach the threshold for splitting for leaf
 		if (operation == Operation::INSERT) {
-			if (node.IsLeafPage() && node.GetSize() < node.GetMaxSize()) {
+			// a leaf splits as soon as an insert makes it reach the max size
+			if (node.IsLeafPage() && node.GetSize() + 1 < node.GetMaxSize()) {
 				return true;
 			}
 			// if internal node have room for one more key value, then it is safe
@@ -368,7 +439,7 @@ protected:
 		assert(page.get().AsMut<BtreePage>().GetPageType() == IndexPageType::HEADER_PAGE);
 		transaction.GetPageSet()->pop_front();
 		page.get().WUnlatch();
-		bpm_.UnpinPage(page.get().GetPageId(), true);
+		bpm_.UnpinPage(page.get(), true);
 	}
 
 	void ReleaseParentWriteLatches(Transaction &transaction) {
@@ -384,7 +455,7 @@ protected:
 
 			// when the page is the header this page can actually be modified when
 			// the current root is split and a new root is created
-			bpm_.UnpinPage(page.get().GetPageId(), false);
+			bpm_.UnpinPage(page.get(), false);
 		}
 	}
 
@@ -392,6 +463,24 @@ protected:
 	}
 
 private:
+	Page &FetchHeaderPage() {
+		return FetchNode({table_meta_.table_oid_, index_meta_.header_page_id_}, HeaderRef());
+	}
+	Page &FetchNode(PageId page_id, std::atomic<Page *> *ref) {
+		return ref != nullptr ? bpm_.FetchPageSwizzled(page_id, *ref) : bpm_.FetchPage(page_id);
+	}
+	OptimisticReadGuard FetchNodeOptimistic(PageId page_id, std::atomic<Page *> *ref) {
+		return ref != nullptr ? bpm_.FetchPageOptimisticSwizzled(page_id, *ref) : bpm_.FetchPageOptimistic(page_id);
+	}
+	// the reference the node in page keeps to the frame of its child in slot, nullptr unless children are swizzled.
+	// the header keeps the root in slot 0
+	std::atomic<Page *> *ChildRef(Page &page, idx_t slot) {
+		return swizzle_children_ ? &page.GetChildRef(slot) : nullptr;
+	}
+	std::atomic<Page *> *HeaderRef() {
+		return swizzle_children_ ? &header_ref_ : nullptr;
+	}
+
 	// pass in the header page to satisfy the assumption that we have the write lock to the header page
 	void CreateNewRoot(const IndexKeyType &key, const IndexValueType &value, BtreeHeaderPage &header_page) {
 		auto root_page_id = PageId {table_meta_.table_oid_};
@@ -404,5 +493,7 @@ private:
 	}
 
 	BufferPool &bpm_;
+	const bool swizzle_children_;
+	std::atomic<Page *> header_ref_ {nullptr};
 };
 } // namespace db
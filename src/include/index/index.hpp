@@ -38,6 +38,8 @@ public:
 	IndexConstraintType index_constraint_type_;
 	page_id_t header_page_id_ {INVALID_PAGE_ID};
 	IndexType index_type_;
+	// name of the buffer pool the index pages are cached in
+	std::string buffer_pool_ {INDEX_BUFFER_POOL};
 
 	void Serialize(Serializer &serializer) const {
 		serializer.WriteProperty(100, "index_name", name_);
@@ -47,6 +49,7 @@ public:
 		serializer.WriteProperty(104, "index_constraint_type", index_constraint_type_);
 		serializer.WriteProperty(105, "header_page_id", header_page_id_);
 		serializer.WriteProperty(106, "index_type", index_type_);
+		serializer.WritePropertyWithDefault(107, "buffer_pool", buffer_pool_, std::string(INDEX_BUFFER_POOL));
 	}
 
 	[[nodiscard]] static std::unique_ptr<IndexMeta> Deserialize(Deserializer &deserializer) {
@@ -58,6 +61,7 @@ public:
 		deserializer.ReadProperty(104, "index_constraint_type", meta->index_constraint_type_);
 		deserializer.ReadProperty(105, "header_page_id", meta->header_page_id_);
 		deserializer.ReadProperty(106, "index_type", meta->index_type_);
+		deserializer.ReadPropertyWithDefault(107, "buffer_pool", meta->buffer_pool_, std::string(INDEX_BUFFER_POOL));
 		return meta;
 	}
 };
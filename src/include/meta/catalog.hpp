@@ -1,6 +1,6 @@
 #pragma once
 
-#include "storage/buffer/buffer_pool.hpp"
+#include "storage/buffer/buffer_pool_set.hpp"
 #include "meta/schema.hpp"
 #include "common/fs_utils.hpp"
 #include "common/typedef.hpp"
@@ -19,7 +19,8 @@
 namespace db {
 class Catalog {
 public:
-	Catalog() {
+	// with the tablespace layout the tables have no data files, only their meta files are created and checked
+	explicit Catalog(StorageLayout layout = StorageLayout::FILE_PER_TABLE) : layout_(layout) {
 		LOG_TRACE("Initializing meta manager...");
 		std::filesystem::path catalogpath = FilePathManager::GetInstance().GetSystemCatalogPath();
 		if (std::filesystem::exists(catalogpath)) {
@@ -34,10 +35,13 @@ public:
 		EnsureTableFilesExist();
 	}
 
-	std::optional<table_oid_t> CreateTable(const std::string &table_name, const Schema &schema);
+	// buffer_pool names the pool the heap pages of the table are cached in
+	std::optional<table_oid_t> CreateTable(const std::string &table_name, const Schema &schema,
+	                                       const std::string &buffer_pool = HEAP_BUFFER_POOL);
 	std::optional<index_oid_t> CreateIndex(const std::string &index_name, const std::string &table_name,
 	                                       const Column &key_col, bool is_primary_key, IndexType index_type,
-	                                       BufferPool &bpm);
+	                                       BufferPoolSet &buffer_pools,
+	                                       const std::string &buffer_pool = INDEX_BUFFER_POOL);
 
 	[[nodiscard]] TableMeta &GetTableByName(const std::string &table_name) const {
 		if (table_names_.find(table_name) == table_names_.end()) {
@@ -120,7 +124,8 @@ private:
 	void EnsureTableFilesExist() {
 		for (const auto &[table_name, table_oid] : table_names_) {
 			LOG_TRACE("Checking table files for table {}", table_name);
-			auto data_exists = std::filesystem::exists(FilePathManager::GetInstance().GetTableDataPath(table_name));
+			auto data_exists = layout_ == StorageLayout::TABLESPACE ||
+			                   std::filesystem::exists(FilePathManager::GetInstance().GetTableDataPath(table_name));
 			auto meta_exists = std::filesystem::exists(FilePathManager::GetInstance().GetTableMetaPath(table_name));
 			if (!data_exists || !meta_exists) {
 				throw Exception("Data file or meta file not found for table " + table_name);
@@ -135,5 +140,6 @@ private:
 	std::unordered_map<std::string, table_oid_t> table_names_;
 	// magic bytes to ensure meta manager is not corrupt
 	std::string magic_bytes_ {"GAVINDB_CATALOG_MANAGER"};
+	StorageLayout layout_;
 };
 } // namespace db
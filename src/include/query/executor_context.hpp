@@ -1,12 +1,12 @@
 #pragma once
 
 #include "meta/catalog.hpp"
-#include "storage/buffer/buffer_pool.hpp"
+#include "storage/buffer/buffer_pool_set.hpp"
 
 namespace db {
 class ExecutorContext {
 public:
-	ExecutorContext(Catalog &catalog, BufferPool &bpm) : catalog {catalog}, bpm_ {bpm} {
+	ExecutorContext(Catalog &catalog, BufferPoolSet &buffer_pools) : catalog {catalog}, buffer_pools_ {buffer_pools} {
 	}
 
 	~ExecutorContext() = default;
@@ -21,11 +21,16 @@ public:
 	}
 
 	[[nodiscard]] BufferPool &GetBufferPoolManager() const {
-		return bpm_;
+		return buffer_pools_.GetDefaultPool();
+	}
+
+	// the pool the table's heap pages are cached in
+	[[nodiscard]] BufferPool &GetBufferPool(const TableMeta &table_meta) const {
+		return buffer_pools_.GetPool(table_meta.buffer_pool_);
 	}
 
 private:
 	Catalog &catalog;
-	BufferPool &bpm_;
+	BufferPoolSet &buffer_pools_;
 };
 } // namespace db
@@ -11,8 +11,8 @@ class SeqScanExecutor : public AbstractExecutor {
 public:
 	SeqScanExecutor(const ExecutorContext &exec_context, std::unique_ptr<SeqScanPlanNode> plan)
 	    : AbstractExecutor(exec_context), plan_(std::move(plan)),
-	      table_heap_(
-	          TableHeap(exec_context.GetBufferPoolManager(), exec_context.GetCatalog().GetTable(plan_->table_oid_))),
+	      table_heap_(TableHeap(exec_context.GetBufferPool(exec_context.GetCatalog().GetTable(plan_->table_oid_)),
+	                            exec_context.GetCatalog().GetTable(plan_->table_oid_))),
 	      table_iter_(table_heap_.MakeIterator()) {
 	}
 
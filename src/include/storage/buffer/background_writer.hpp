@@ -0,0 +1,59 @@
+#pragma once
+
+#include "common/config.hpp"
+#include "common/page_id.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+namespace db {
+class BufferPool;
+
+struct BackgroundWriterConfig {
+	// sleep between two rounds
+	std::chrono::milliseconds interval_ {BACKGROUND_WRITER_INTERVAL_MS};
+	// upper bound of pages written per round, limits the io the writer adds on top of foreground traffic
+	size_t max_pages_per_round_ {BACKGROUND_WRITER_MAX_PAGES_PER_ROUND};
+	// number of dirty pages in the pool that wakes the writer before its interval is over
+	size_t dirty_page_watermark_ {BACKGROUND_WRITER_DIRTY_PAGE_WATERMARK};
+};
+
+/**
+ * BackgroundWriter trickles dirty pages out of the buffer pool so eviction finds clean victims and foreground
+ * queries do not have to flush. Every round it writes up to max_pages_per_round_ dirty pages in page id order,
+ * continuing after the last page it wrote in the previous round. Pages latched by other threads are skipped.
+ */
+class BackgroundWriter {
+public:
+	BackgroundWriter(BufferPool &bpm, BackgroundWriterConfig config);
+	BackgroundWriter(const BackgroundWriter &) = delete;
+	BackgroundWriter &operator=(const BackgroundWriter &) = delete;
+	~BackgroundWriter();
+
+	// wake the writer up if the pool holds more dirty pages than the watermark
+	void NotifyDirty(size_t num_dirty_pages);
+	// write one round synchronously, returns the number of pages written
+	size_t RunRound();
+	void Stop();
+
+	[[nodiscard]] const BackgroundWriterConfig &GetConfig() const {
+		return config_;
+	}
+
+private:
+	void Run();
+
+	BufferPool &bpm_;
+	const BackgroundWriterConfig config_;
+	// the round starts at the first dirty page after this one
+	PageId cursor_;
+	bool stop_ {false};
+	bool wake_up_ {false};
+	std::mutex latch_;
+	std::condition_variable cv_;
+	std::thread thread_;
+};
+} // namespace db
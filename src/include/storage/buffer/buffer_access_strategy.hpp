@@ -0,0 +1,77 @@
+#pragma once
+
+#include "common/config.hpp"
+#include "common/page_id.hpp"
+#include "common/typedef.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace db {
+// ring of frames a bulk operation keeps reusing within one buffer pool shard
+struct BufferRing {
+	struct Slot {
+		frame_id_t frame_id_;
+		// the page the ring put into the frame, a mismatch means the frame was taken over by someone else
+		PageId page_id_;
+	};
+
+	explicit BufferRing(size_t capacity) : capacity_(capacity) {
+		slots_.reserve(capacity_);
+	}
+
+	// the slot whose frame is reused next, only valid once the ring is full
+	[[nodiscard]] const Slot *GetReusableSlot() const {
+		if (slots_.size() < capacity_) {
+			return nullptr;
+		}
+		return &slots_[next_];
+	}
+
+	void Record(frame_id_t frame_id, PageId page_id) {
+		if (slots_.size() < capacity_) {
+			slots_.push_back({frame_id, page_id});
+			return;
+		}
+		slots_[next_] = {frame_id, page_id};
+		next_ = (next_ + 1) % capacity_;
+	}
+
+	const size_t capacity_;
+	std::vector<Slot> slots_;
+	size_t next_ {0};
+};
+
+/**
+ * BufferAccessStrategy confines the misses of a large sequential scan to a small private ring of frames instead of
+ * cycling every page through the shared pool, similar to PostgreSQL's bulk read ring buffers. Once the ring is full a
+ * miss reuses the oldest ring frame if nobody else pinned or took it over in the meantime. Hits are unaffected.
+ * A strategy belongs to one scan and is not shared between threads.
+ */
+class BufferAccessStrategy {
+public:
+	BufferAccessStrategy(size_t num_shards, size_t ring_size) {
+		// the ring is split over the shards because every page is cached by the shard it hashes to. consecutive pages
+		// scatter over the shards, so a shard does not get a fair share of them and its ring is kept from getting too
+		// small to hold the pages read ahead of the scan
+		auto shard_ring_size = std::max<size_t>(BULK_READ_MIN_SHARD_RING_SIZE, ring_size / num_shards);
+		rings_.reserve(num_shards);
+		for (size_t i = 0; i < num_shards; ++i) {
+			rings_.emplace_back(shard_ring_size);
+		}
+	}
+
+	BufferRing &GetRing(size_t shard_idx) {
+		return rings_[shard_idx];
+	}
+
+	// frames of the ring of every shard
+	[[nodiscard]] size_t GetShardRingSize() const {
+		return rings_.front().capacity_;
+	}
+
+private:
+	std::vector<BufferRing> rings_;
+};
+} // namespace db
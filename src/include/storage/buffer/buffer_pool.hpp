@@ -1,42 +1,126 @@
 #pragma once
 
+#include "common/config.hpp"
 #include "common/page_id.hpp"
 #include "common/typedef.hpp"
+#include "storage/buffer/background_writer.hpp"
+#include "storage/buffer/buffer_access_strategy.hpp"
+#include "storage/buffer/buffer_pool_metrics.hpp"
+#include "storage/buffer/buffer_pool_shard.hpp"
+#include "storage/buffer/frame_arena.hpp"
 #include "storage/buffer/replacer.hpp"
 #include "storage/disk_manager.hpp"
 #include "storage/page/page.hpp"
 #include "storage/page/page_guard.hpp"
 #include "storage/page_allocator.hpp"
 
-#include <list>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <vector>
 namespace db {
+/**
+ * BufferPool partitions its frames into shards. A page id always hashes to the same shard, which owns its own page
+ * table, free list, replacer and latch, so threads working on different pages rarely contend on the same mutex.
+ */
 class BufferPool {
 public:
-	BufferPool(frame_id_t pool_size, DiskManager &disk_manager);
+	// num_shards = 0 picks one shard per core while keeping at least BUFFER_POOL_MIN_SHARD_SIZE frames per shard.
+	// the pool can be resized up to max_pool_size frames, 0 means it cannot grow past pool_size.
+	// use_huge_pages backs the frame arena with transparent huge pages where the os supports it
+	BufferPool(frame_id_t pool_size, DiskManager &disk_manager, ReplacerType replacer_type = ReplacerType::LRU_K,
+	           uint32_t num_shards = 0, frame_id_t max_pool_size = 0, bool use_huge_pages = false);
 	BufferPool(const BufferPool &) = delete;
 	BufferPool &operator=(const BufferPool &) = delete;
-	bool FlushPage(PageId page_id);
+	~BufferPool();
+	// with wait_for_latch unset a page that is latched by another thread is skipped instead of waited for
+	bool FlushPage(PageId page_id, bool wait_for_latch = true);
+	// writes the pages back in file order, FLUSH_BATCH_PAGES at a time with adjacent pages in one vectored write. pages
+	// that are not cached are skipped, and so are latched ones unless wait_for_latch is set. returns which were written
+	std::vector<uint8_t> FlushPages(std::span<const PageId> page_ids, bool wait_for_latch = true);
+	// writes every dirty page and makes the writes durable, clean frames are skipped
 	void FlushAllPages();
+	[[nodiscard]] std::vector<PageId> CollectDirtyPages();
 	BasicPageGuard FetchPageBasic(PageId page_id);
-	ReadPageGuard FetchPageRead(PageId page_id);
+	// a strategy keeps the misses of a bulk read inside its own ring of frames
+	ReadPageGuard FetchPageRead(PageId page_id, BufferAccessStrategy *strategy = nullptr);
 	WritePageGuard FetchPageWrite(PageId page_id);
+	// starts an optimistic read of the page in its frame, neither pinned nor latched. a page that is not resident is read
+	// in first
+	OptimisticReadGuard FetchPageOptimistic(PageId page_id);
+	// follow a swizzled reference to the frame of page_id, as kept by b+tree nodes for their children. the page table
+	// is only consulted when the reference is missing or stale, and the reference is pointed at the new frame then
+	Page &FetchPageSwizzled(PageId page_id, std::atomic<Page *> &ref);
+	OptimisticReadGuard FetchPageOptimisticSwizzled(PageId page_id, std::atomic<Page *> &ref);
 	BasicPageGuard NewPageGuarded(PageAllocator &page_allocator, PageId &page_id);
 	bool UnpinPage(PageId page_id, bool is_dirty);
+	// used by the page guards, which hold on to the frame and skip the page table lookup
+	bool UnpinPage(Page &page, bool is_dirty);
 	Page &NewPage(PageAllocator &page_allocator, PageId &page_id);
-	Page &FetchPage(PageId page_id);
+	Page &FetchPage(PageId page_id, BufferAccessStrategy *strategy = nullptr);
+	// loads the pages [first_page_id, first_page_id + num_pages) of one table file that are not cached yet, adjacent
+	// misses are read with a single disk read. best effort, a page that cannot be loaded is skipped
+	void PrefetchPages(PageId first_page_id, uint32_t num_pages, BufferAccessStrategy *strategy = nullptr);
+	// pins a batch of pages, guard i holds page_ids[i]. cached pages are pinned with one latch acquisition per shard
+	// and the misses are read together, sorted by file and offset. a batch must fit into the pool
+	std::vector<BasicPageGuard> FetchPages(std::span<const PageId> page_ids, BufferAccessStrategy *strategy = nullptr);
 	bool DeletePage(PageId page_id);
+	[[nodiscard]] bool IsResident(PageId page_id);
+	[[nodiscard]] std::unique_ptr<BufferAccessStrategy> MakeBulkReadStrategy() const;
+	// writes the cached pages ordered from the hottest to the coldest, a restarted pool reloads them with
+	// LoadResidentPages instead of refilling through misses
+	void SaveResidentPages(const std::filesystem::path &path);
+	// reads back the hottest pages of a dump that fit into the pool, sorted by file and offset and in batches of
+	// adjacent pages. best effort, pages that no longer exist are skipped. returns the number of pages requested
+	size_t LoadResidentPages(const std::filesystem::path &path);
+	// grows or shrinks the pool while it is in use, a shrink returns once the dropped frames are written back and
+	// freed. frames still pinned after the timeout are kept, returns the size the pool was resized to
+	frame_id_t Resize(frame_id_t pool_size,
+	                  std::chrono::milliseconds timeout = std::chrono::milliseconds(BUFFER_POOL_RESIZE_TIMEOUT_MS));
+
+	[[nodiscard]] size_t GetNumShards() const {
+		return shards_.size();
+	}
+	[[nodiscard]] frame_id_t GetPoolSize() const {
+		return pool_size_.load(std::memory_order_relaxed);
+	}
+	[[nodiscard]] frame_id_t GetMaxPoolSize() const {
+		return max_pool_size_;
+	}
+	[[nodiscard]] const FrameArena &GetFrameArena() const {
+		return arena_;
+	}
+	[[nodiscard]] size_t GetNumDirtyPages() const;
+	// sums up the counters of every shard
+	[[nodiscard]] BufferPoolMetricsSnapshot GetMetrics() const;
+
+	void StartBackgroundWriter(BackgroundWriterConfig config = {});
+	void StopBackgroundWriter();
 
 private:
-	bool AllocateFrame(frame_id_t &frame_id);
+	static uint32_t PickNumShards(frame_id_t pool_size);
+	// spreads the remainder over the first shards
+	frame_id_t GetShardSize(frame_id_t pool_size, size_t shard_idx) const;
+	size_t GetShardIndex(PageId page_id) const;
+	BufferPoolShard &GetShard(PageId page_id);
+	// reads claimed frames, sorted by PageId::Pack, coalescing adjacent pages of a table. returns which were read
+	std::vector<uint8_t> ReadClaimedPages(std::span<Page *const> pages);
 
-	const frame_id_t pool_size_;
-	std::unique_ptr<Replacer> replacer_;
+	std::atomic<frame_id_t> pool_size_;
+	const frame_id_t max_pool_size_;
 	DiskManager &disk_manager_;
-	std::list<frame_id_t> free_list_;
-	std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_;
-	std::vector<Page> pages_;
-	std::mutex latch_;
+	// holds the page data of every shard, has to outlive them
+	FrameArena arena_;
+	std::vector<std::unique_ptr<BufferPoolShard>> shards_;
+	std::unique_ptr<BackgroundWriter> background_writer_;
+	// page allocators are not thread safe, serialize them here as the pool used to under its global latch
+	std::mutex allocation_latch_;
+	std::mutex resize_latch_;
+	// counters of the batched io the pool issues itself rather than through a shard: the read-ahead, the claimed pages
+	// read for FetchPages and the warm restart, and the writes of FlushPages
+	BufferPoolMetrics metrics_;
 };
 } // namespace db
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "common/config.hpp"
+#include "common/page_id.hpp"
+#include "common/typedef.hpp"
+#include "storage/buffer/frame_descriptor.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+namespace db {
+struct LatencyHistogramSnapshot {
+	// bucket i counts the samples in [2^(i-1), 2^i) microseconds, bucket 0 the ones below a microsecond
+	static constexpr size_t NUM_BUCKETS = 32;
+
+	std::array<uint64_t, NUM_BUCKETS> buckets_ {};
+	uint64_t count_ {0};
+	uint64_t total_us_ {0};
+
+	// upper bound in microseconds of the bucket that holds the given percentile, 0 without samples
+	[[nodiscard]] uint64_t Percentile(double percentile) const;
+	void Merge(const LatencyHistogramSnapshot &other);
+};
+
+class LatencyHistogram {
+public:
+	void Record(std::chrono::nanoseconds latency);
+	[[nodiscard]] LatencyHistogramSnapshot Snapshot() const;
+
+private:
+	std::array<std::atomic<uint64_t>, LatencyHistogramSnapshot::NUM_BUCKETS> buckets_ {};
+	std::atomic<uint64_t> total_us_ {0};
+};
+
+struct TableMetricsSnapshot {
+	uint64_t hits_ {0};
+	uint64_t misses_ {0};
+	uint64_t evictions_ {0};
+};
+
+struct BufferPoolMetricsSnapshot {
+	uint64_t hits_ {0};
+	// hits that followed a swizzled child reference of a b+tree node instead of looking up the page table
+	uint64_t swizzled_hits_ {0};
+	uint64_t misses_ {0};
+	uint64_t clean_evictions_ {0};
+	uint64_t dirty_evictions_ {0};
+	uint64_t flushes_ {0};
+	uint64_t prefetched_pages_ {0};
+	// waits for a read or write-back of the same page issued by another thread
+	uint64_t pin_waits_ {0};
+	std::chrono::nanoseconds pin_wait_time_ {0};
+	// acquisitions of a shard latch that was held by another thread
+	uint64_t latch_waits_ {0};
+	std::chrono::nanoseconds latch_wait_time_ {0};
+	LatencyHistogramSnapshot read_latency_;
+	LatencyHistogramSnapshot write_latency_;
+	// tables with pages seen by the pool
+	std::map<table_oid_t, TableMetricsSnapshot> tables_;
+
+	[[nodiscard]] double GetHitRatio() const {
+		return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+	}
+	void Merge(const BufferPoolMetricsSnapshot &other);
+	[[nodiscard]] std::string ToString() const;
+};
+
+/**
+ * Counters of one buffer pool shard. Every counter is a relaxed atomic bumped by the thread doing the work, the
+ * shard keeps its own instance so threads on different shards do not share cache lines. Latch waits are only timed
+ * when the latch was not free, an uncontended acquisition costs no clock reads. The per-table counters live in chunks
+ * of TABLE_CHUNK_SIZE tables that are created on the first page of one of their tables and never move, so counting a
+ * table that has its chunk is two atomic loads.
+ */
+class alignas(CACHE_LINE_SIZE) BufferPoolMetrics {
+public:
+	static constexpr size_t TABLE_CHUNK_SIZE = 64;
+
+	BufferPoolMetrics();
+	BufferPoolMetrics(const BufferPoolMetrics &) = delete;
+	BufferPoolMetrics &operator=(const BufferPoolMetrics &) = delete;
+	~BufferPoolMetrics();
+
+	void RecordHit(PageId page_id) {
+		Bump(hits_);
+		if (auto *table = GetTable(page_id); table != nullptr) {
+			Bump(table->hits_);
+		}
+	}
+	void RecordSwizzledHit(PageId page_id) {
+		Bump(swizzled_hits_);
+		RecordHit(page_id);
+	}
+	void RecordMiss(PageId page_id) {
+		Bump(misses_);
+		if (auto *table = GetTable(page_id); table != nullptr) {
+			Bump(table->misses_);
+		}
+	}
+	void RecordEviction(PageId page_id, bool is_dirty) {
+		Bump(is_dirty ? dirty_evictions_ : clean_evictions_);
+		if (auto *table = GetTable(page_id); table != nullptr) {
+			Bump(table->evictions_);
+		}
+	}
+	void RecordFlush() {
+		Bump(flushes_);
+	}
+	void RecordPrefetch(uint64_t num_pages) {
+		prefetched_pages_.fetch_add(num_pages, std::memory_order_relaxed);
+	}
+	void RecordPinWait(std::chrono::nanoseconds wait_time) {
+		Bump(pin_waits_);
+		pin_wait_ns_.fetch_add(wait_time.count(), std::memory_order_relaxed);
+	}
+	void RecordLatchWait(std::chrono::nanoseconds wait_time) {
+		Bump(latch_waits_);
+		latch_wait_ns_.fetch_add(wait_time.count(), std::memory_order_relaxed);
+	}
+	void RecordRead(std::chrono::nanoseconds latency) {
+		read_latency_.Record(latency);
+	}
+	void RecordWrite(std::chrono::nanoseconds latency) {
+		write_latency_.Record(latency);
+	}
+
+	[[nodiscard]] BufferPoolMetricsSnapshot Snapshot() const;
+
+private:
+	struct TableCounters {
+		std::atomic<uint64_t> hits_ {0};
+		std::atomic<uint64_t> misses_ {0};
+		std::atomic<uint64_t> evictions_ {0};
+	};
+	using TableChunk = std::array<TableCounters, TABLE_CHUNK_SIZE>;
+	// tables are indexed by oid + 1 so the system catalog is at 0, chunk i holds the indexes [i * TABLE_CHUNK_SIZE,
+	// (i + 1) * TABLE_CHUNK_SIZE). a directory is replaced by a larger copy when a table outside of it shows up, the
+	// old one is kept until the metrics go away since readers may still look at it
+	struct ChunkDirectory {
+		explicit ChunkDirectory(size_t num_chunks) : chunks_(num_chunks) {
+		}
+		std::vector<std::atomic<TableChunk *>> chunks_;
+	};
+
+	static void Bump(std::atomic<uint64_t> &counter) {
+		counter.fetch_add(1, std::memory_order_relaxed);
+	}
+	TableCounters *GetTable(PageId page_id) {
+		// no table has an oid below the system catalog's, the page is only counted in the totals
+		if (page_id.table_id_ < SYSTEM_CATALOG_ID) {
+			return nullptr;
+		}
+		auto table_idx = static_cast<size_t>(page_id.table_id_ - SYSTEM_CATALOG_ID);
+		auto chunk_idx = table_idx / TABLE_CHUNK_SIZE;
+		auto *directory = directory_.load(std::memory_order_acquire);
+		TableChunk *chunk = nullptr;
+		if (chunk_idx < directory->chunks_.size()) {
+			chunk = directory->chunks_[chunk_idx].load(std::memory_order_acquire);
+		}
+		if (chunk == nullptr) {
+			chunk = AddChunk(chunk_idx);
+		}
+		return &(*chunk)[table_idx % TABLE_CHUNK_SIZE];
+	}
+	TableChunk *AddChunk(size_t chunk_idx);
+
+	std::atomic<uint64_t> hits_ {0};
+	std::atomic<uint64_t> swizzled_hits_ {0};
+	std::atomic<uint64_t> misses_ {0};
+	std::atomic<uint64_t> clean_evictions_ {0};
+	std::atomic<uint64_t> dirty_evictions_ {0};
+	std::atomic<uint64_t> flushes_ {0};
+	std::atomic<uint64_t> prefetched_pages_ {0};
+	std::atomic<uint64_t> pin_waits_ {0};
+	std::atomic<uint64_t> pin_wait_ns_ {0};
+	std::atomic<uint64_t> latch_waits_ {0};
+	std::atomic<uint64_t> latch_wait_ns_ {0};
+	LatencyHistogram read_latency_;
+	LatencyHistogram write_latency_;
+	std::atomic<ChunkDirectory *> directory_;
+	// guards growing the directory and adding chunks, and owns both
+	std::mutex table_latch_;
+	std::vector<std::unique_ptr<ChunkDirectory>> directories_;
+	std::vector<std::unique_ptr<TableChunk>> chunks_;
+};
+} // namespace db
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common/config.hpp"
+#include "common/typedef.hpp"
+#include "storage/buffer/buffer_pool.hpp"
+#include "storage/buffer/buffer_pool_metrics.hpp"
+#include "storage/buffer/replacer.hpp"
+#include "storage/disk_manager.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+namespace db {
+struct BufferPoolConfig {
+	std::string name_ {DEFAULT_BUFFER_POOL};
+	frame_id_t pool_size_ {DEFAULT_POOL_SIZE};
+	// 0 keeps the pool at pool_size_
+	frame_id_t max_pool_size_ {0};
+	ReplacerType replacer_type_ {ReplacerType::LRU_K};
+	bool use_huge_pages_ {false};
+};
+
+/**
+ * Named buffer pools on top of one disk manager, each with its own frames, size and replacer. Table and index
+ * metadata in the catalog name the pool the object is cached in, so for example a large heap scan in the heap pool
+ * cannot evict the pages of the index pool. An object whose pool is not configured is cached in the default pool.
+ * Pools are added at startup, lookups do not synchronize with AddPool.
+ */
+class BufferPoolSet {
+public:
+	// starts out with the default pool
+	BufferPoolSet(DiskManager &disk_manager, const BufferPoolConfig &default_pool_config = {});
+	BufferPoolSet(const BufferPoolSet &) = delete;
+	BufferPoolSet &operator=(const BufferPoolSet &) = delete;
+
+	BufferPool &AddPool(const BufferPoolConfig &config);
+	// falls back to the default pool if there is no pool of that name
+	BufferPool &GetPool(const std::string &name);
+	// throws if there is no pool of that name, for callers that name a pool to change it
+	BufferPool &GetExistingPool(const std::string &name);
+	BufferPool &GetDefaultPool() {
+		return *default_pool_;
+	}
+	[[nodiscard]] bool HasPool(const std::string &name) const {
+		return pools_.contains(name);
+	}
+	[[nodiscard]] std::vector<std::string> GetPoolNames() const;
+
+	// every pool gets a writer of its own with the same config
+	void StartBackgroundWriters(BackgroundWriterConfig config = {});
+	void StopBackgroundWriters();
+	void FlushAllPages();
+	// every pool keeps its own dump of resident pages, see BufferPool::SaveResidentPages
+	void SaveResidentPages();
+	size_t LoadResidentPages();
+	[[nodiscard]] std::map<std::string, BufferPoolMetricsSnapshot> GetMetrics() const;
+
+private:
+	DiskManager &disk_manager_;
+	std::map<std::string, std::unique_ptr<BufferPool>> pools_;
+	BufferPool *default_pool_;
+};
+} // namespace db
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "common/page_id.hpp"
+#include "common/typedef.hpp"
+#include "storage/buffer/buffer_access_strategy.hpp"
+#include "storage/buffer/buffer_pool_metrics.hpp"
+#include "storage/buffer/frame_arena.hpp"
+#include "storage/buffer/frame_descriptor.hpp"
+#include "storage/buffer/page_table.hpp"
+#include "storage/buffer/replacer.hpp"
+#include "storage/disk_manager.hpp"
+#include "storage/page/page.hpp"
+#include "storage/page/page_guard.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_set>
+#include <vector>
+namespace db {
+/**
+ * One partition of the buffer pool, owns the frames of every page id that hashes to it.
+ * Disk reads and write-backs run without the shard latch. While a frame is being filled it is marked as io in
+ * progress and already mapped in the page table, so concurrent misses on the same page wait for that single read
+ * instead of issuing their own. A dirty victim stays in pages_being_written_ until its write-back finishes so it
+ * cannot be read back from disk in a stale state.
+ * Pin counts and dirty flags live in a separate array of cache line aligned frame descriptors. A hit on a resident
+ * page is a probe of the flat page table plus an atomic increment of the pin count, without the latch. Unpinning a
+ * frame that other threads still pin, and that is clean or already dirty, does not take the latch either.
+ * Descriptors, page metadata, page table and replacer are sized for max_pool_size frames up front, the page data is
+ * a slice of the pool's frame arena starting at first_arena_frame. Frames past the current size are retired: they
+ * stay locked, so lookups through stale page table entries cannot pin them, and their memory goes back to the os.
+ */
+class BufferPoolShard {
+public:
+	BufferPoolShard(frame_id_t pool_size, frame_id_t max_pool_size, FrameArena &arena, size_t first_arena_frame,
+	                DiskManager &disk_manager, ReplacerType replacer_type);
+	BufferPoolShard(const BufferPoolShard &) = delete;
+	BufferPoolShard &operator=(const BufferPoolShard &) = delete;
+	// with wait_for_latch unset a page that is latched by another thread is skipped instead of waited for
+	bool FlushPage(PageId page_id, bool wait_for_latch = true);
+	// pins and read latches a cached page for a write-back by the caller and clears its dirty flag. returns nullptr if
+	// the page is not cached, or if it is latched by another thread and wait_for_latch is unset
+	Page *BeginFlush(PageId page_id, bool wait_for_latch);
+	// drops what BeginFlush took, a failed write marks the page dirty again
+	void FinishFlush(Page &page, bool success);
+	// returns the dirty pages of the shard in frame order
+	std::vector<PageId> CollectDirtyPages();
+	// returns the pages cached in the shard from the hottest to the coldest
+	std::vector<PageId> CollectResidentPages();
+	bool UnpinPage(PageId page_id, bool is_dirty);
+	// unpins a frame handed out by this shard without looking it up in the page table
+	bool UnpinPage(Page &page, bool is_dirty);
+	// page_id has to be freshly allocated and not present in the shard
+	Page &NewPage(PageId page_id);
+	// misses are served from the ring's frames when one is passed
+	Page &FetchPage(PageId page_id, BufferRing *ring = nullptr);
+	bool DeletePage(PageId page_id);
+	bool IsResident(PageId page_id);
+	// claims a pinned frame marked as io in progress for a page the caller reads in itself, returns nullptr if the
+	// page is already cached or on its way to disk, or if no frame can be freed
+	Page *ClaimForPrefetch(PageId page_id, BufferRing *ring);
+	// publishes a frame filled by the caller and drops the claim unless keep_pin is set, a failed read gives the frame
+	// back
+	void FinishPrefetch(Page &page, bool success, bool keep_pin = false);
+	// pins a batch of pages under one latch acquisition. resident pages are pinned, missing ones get a frame claimed
+	// as in ClaimForPrefetch with is_claimed set. pages that are in flight, or for which no frame can be freed, are
+	// left at nullptr for the caller to fetch one by one
+	void PinOrClaim(std::span<const PageId> page_ids, std::span<Page *> pages, std::span<uint8_t> is_claimed,
+	                BufferRing *ring);
+
+	// pins page_id through a swizzled reference to its frame, skipping the page table. returns nullptr if the frame
+	// was handed to another page since the reference was taken
+	Page *TryFetchSwizzled(Page &page, PageId page_id);
+	// starts an optimistic read of a resident page without pinning it. returns nullopt if the page is not resident,
+	// is still being read in or is write latched
+	std::optional<OptimisticReadGuard> TryReadResident(PageId page_id);
+	// same for the frame a swizzled reference points at
+	std::optional<OptimisticReadGuard> TryReadSwizzled(Page &page, PageId page_id);
+
+	// new frames go to the free list, a shrink writes back and drops the frames past pool_size as soon as they are
+	// unpinned. frames still pinned at the deadline are kept, the shard then ends after the last of them. returns the
+	// size the shard was resized to
+	frame_id_t Resize(frame_id_t pool_size, std::chrono::steady_clock::time_point deadline);
+
+	[[nodiscard]] frame_id_t GetPoolSize() const {
+		return pool_size_.load(std::memory_order_relaxed);
+	}
+	[[nodiscard]] const BufferPoolMetrics &GetMetrics() const {
+		return metrics_;
+	}
+	[[nodiscard]] size_t GetNumDirtyPages() const {
+		return num_dirty_.load(std::memory_order_relaxed);
+	}
+
+private:
+	// takes the shard latch, the time spent waiting for it is recorded if it was held by another thread
+	std::unique_lock<std::mutex> LockLatch();
+	static std::unique_ptr<Replacer> MakeReplacer(ReplacerType replacer_type, frame_id_t pool_size);
+	bool AllocateFrame(frame_id_t &frame_id, BufferRing *ring);
+	// maps page_id to a pinned frame marked as io in progress, returns the evicted page if it has to be written back
+	Page &ClaimFrame(PageId page_id, std::optional<PageId> &dirty_victim, BufferRing *ring);
+	Page &ClaimFrame(PageId page_id, frame_id_t frame_id, std::optional<PageId> &dirty_victim, BufferRing *ring);
+	void WriteBackVictim(std::unique_lock<std::mutex> &lock, Page &page, PageId victim_page_id);
+	void FinishIo(FrameDescriptor &desc);
+	// keeps dirty_frames_ and num_dirty_ in sync with the dirty flag of the frame
+	void SetDirty(FrameDescriptor &desc, bool is_dirty);
+	// with record_access unset the pin does not count as an access for the replacer
+	void PinFrame(FrameDescriptor &desc, bool record_access);
+	void UnpinFrame(FrameDescriptor &desc);
+	bool UnpinLatched(FrameDescriptor &desc, bool is_dirty);
+	// pins a resident page without the latch, returns nullptr if the page has to be fetched under the latch
+	Page *TryFetchResident(PageId page_id);
+	// pins the frame if it holds page_id and is not being filled
+	bool TryPinResident(Page &page, PageId page_id);
+	frame_id_t GetFrameId(const FrameDescriptor &desc) const {
+		return static_cast<frame_id_t>(&desc - descriptors_.get());
+	}
+	Page &GetPage(frame_id_t frame_id) {
+		return pages_[frame_id];
+	}
+	// hands a retired frame out again
+	void AddFrame(frame_id_t frame_id);
+	// returns false if the frame is still in use, dirty frames are collected to be flushed by the caller
+	bool TryRetireFrame(frame_id_t frame_id, std::vector<PageId> &dirty_pages);
+	void AbortIo(FrameDescriptor &desc);
+	// waits for an in flight read of the frame, returns false if the read failed
+	bool WaitForResident(std::unique_lock<std::mutex> &lock, FrameDescriptor &desc, PageId page_id);
+
+	const frame_id_t max_pool_size_;
+	std::atomic<frame_id_t> pool_size_;
+	std::unique_ptr<Replacer> replacer_;
+	DiskManager &disk_manager_;
+	std::list<frame_id_t> free_list_;
+	PageTable page_table_;
+	std::unordered_set<PageId, PageIdHash> pages_being_written_;
+	std::unique_ptr<FrameDescriptor[]> descriptors_;
+	std::unique_ptr<Page[]> pages_;
+	FrameArena &arena_;
+	const size_t first_arena_frame_;
+	// frames that became dirty, may hold stale or duplicate entries until the next CollectDirtyPages
+	std::vector<frame_id_t> dirty_frames_;
+	std::atomic<size_t> num_dirty_ {0};
+	std::mutex latch_;
+	std::condition_variable io_cv_;
+	BufferPoolMetrics metrics_;
+};
+} // namespace db
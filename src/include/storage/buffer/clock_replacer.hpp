@@ -0,0 +1,37 @@
+#pragma once
+
+#include "storage/buffer/replacer.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace db {
+/**
+ * ClockReplacer approximates LRU with a second-chance sweep. Pin and Unpin only store to per-frame atomic flags, so
+ * the hit path does not allocate or touch any shared structure. Evict moves the clock hand and clears reference bits
+ * until it finds an evictable frame that was not referenced since the last sweep; it gives up after two full turns.
+ * Evict calls have to be serialized by the caller. Pin and Unpin may run concurrently with each other and with Evict,
+ * which only takes a frame by flipping its evictable flag from set to clear, so a frame pinned meanwhile is skipped.
+ */
+class ClockReplacer : public Replacer {
+public:
+	explicit ClockReplacer(frame_id_t num_frames);
+	~ClockReplacer() override = default;
+	auto Evict(frame_id_t &frame_id) -> bool override;
+	void Pin(frame_id_t frame_id) override;
+	void PinWithoutAccess(frame_id_t frame_id) override;
+	void Unpin(frame_id_t frame_id) override;
+	void Remove(frame_id_t frame_id) override;
+	void SortByHotness(std::vector<frame_id_t> &frames) const override;
+	void Print() override;
+
+private:
+	struct ClockFrame {
+		std::atomic<bool> is_referenced_ {false};
+		std::atomic<bool> is_evictable_ {false};
+	};
+
+	std::vector<ClockFrame> frames_;
+	size_t hand_ {0};
+};
+} // namespace db
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "common/config.hpp"
+
+#include <cstddef>
+namespace db {
+/**
+ * One contiguous mapping that holds the data of every buffer frame, frame i starts at byte i * PAGE_SIZE. The mapping
+ * is page aligned, so a frame can be handed to O_DIRECT reads or registered as an io_uring fixed buffer. Address space
+ * is reserved for the largest pool size, memory is only committed once a frame is touched and can be handed back with
+ * Release when the pool shrinks. With use_huge_pages the mapping is aligned to 2 MB and transparent huge pages are
+ * requested, which cuts TLB misses on large pools.
+ */
+class FrameArena {
+public:
+	FrameArena(size_t num_frames, bool use_huge_pages);
+	FrameArena(const FrameArena &) = delete;
+	FrameArena &operator=(const FrameArena &) = delete;
+	~FrameArena();
+
+	char *GetFrame(size_t frame_idx) const {
+		return frames_ + frame_idx * PAGE_SIZE;
+	}
+	// gives the memory of the frames back to the os, they read as zeros when touched again
+	void Release(size_t first_frame_idx, size_t num_frames);
+
+	[[nodiscard]] size_t GetNumFrames() const {
+		return num_frames_;
+	}
+	[[nodiscard]] bool UsesHugePages() const {
+		return uses_huge_pages_;
+	}
+
+private:
+	static constexpr size_t HUGE_PAGE_SIZE = 2UL << 20;
+
+	size_t num_frames_;
+	bool uses_huge_pages_ {false};
+	// the whole mapping, may start before frames_ to leave room for the huge page alignment
+	void *mapping_ {nullptr};
+	size_t mapping_size_ {0};
+	char *frames_ {nullptr};
+};
+} // namespace db
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "common/page_id.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace db {
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * Bookkeeping of one buffer frame, kept apart from the page data so pin and unpin touch a single cache line of their
+ * own instead of the line next to the page latch. The pin count is atomic, a resident page is pinned without the shard
+ * latch. To take a frame over for another page, the shard swaps a zero pin count for FRAME_LOCKED, which makes
+ * concurrent pins fail until the frame is handed out again. Only the last unpin goes through the latch, since it
+ * makes the frame evictable.
+ */
+struct alignas(CACHE_LINE_SIZE) FrameDescriptor {
+	static constexpr uint32_t FRAME_LOCKED = 1U << 31;
+
+	// fails while the frame is being taken over, the caller has to check the page id once the pin is held
+	bool TryPin() {
+		auto pin_count = pin_count_.load(std::memory_order_relaxed);
+		while ((pin_count & FRAME_LOCKED) == 0) {
+			if (pin_count_.compare_exchange_weak(pin_count, pin_count + 1, std::memory_order_acquire)) {
+				// the access is handed to the replacer by the last unpin
+				is_referenced_.store(true, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// drops a pin as long as it is not the last one, the last pin has to be dropped under the shard latch
+	bool TryUnpinShared() {
+		auto pin_count = pin_count_.load(std::memory_order_relaxed);
+		while (pin_count > 1) {
+			if (pin_count_.compare_exchange_weak(pin_count, pin_count - 1, std::memory_order_release)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// only called under the shard latch, succeeds if nobody holds a pin
+	bool TryLock() {
+		uint32_t unpinned = 0;
+		return pin_count_.compare_exchange_strong(unpinned, FRAME_LOCKED, std::memory_order_acquire);
+	}
+
+	// the fields below are only written under the shard latch
+	std::atomic<PageId> page_id_ {PageId {}};
+	std::atomic<uint32_t> pin_count_ {0};
+	std::atomic<bool> is_dirty_ {false};
+	// set by pins taken without the latch, they are recorded as an access once the frame is unpinned
+	std::atomic<bool> is_referenced_ {false};
+	// set while the frame is filled from disk or its previous content is written back
+	std::atomic<bool> io_in_progress_ {false};
+};
+static_assert(sizeof(FrameDescriptor) == CACHE_LINE_SIZE, "a frame descriptor should fill exactly one cache line");
+} // namespace db
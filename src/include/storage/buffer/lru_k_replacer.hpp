@@ -0,0 +1,49 @@
+#pragma once
+
+#include "storage/buffer/replacer.hpp"
+
+#include <cstdint>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace db {
+/**
+ * LRUKReplacer evicts the frame whose backward k-distance is the largest. The backward k-distance is the difference
+ * between the current timestamp and the timestamp of the k-th previous access. Frames with fewer than k recorded
+ * accesses have a +inf k-distance and are evicted first, in LRU order of their earliest access.
+ * Evictable frames are kept ordered by their eviction key so Evict is O(log n).
+ */
+class LRUKReplacer : public Replacer {
+public:
+	LRUKReplacer(frame_id_t num_frames, uint32_t k);
+	~LRUKReplacer() override = default;
+	auto Evict(frame_id_t &frame_id) -> bool override;
+	void Pin(frame_id_t frame_id) override;
+	void PinWithoutAccess(frame_id_t frame_id) override;
+	void Unpin(frame_id_t frame_id) override;
+	void Remove(frame_id_t frame_id) override;
+	void SortByHotness(std::vector<frame_id_t> &frames) const override;
+	void Print() override;
+
+private:
+	// {has k accesses, earliest tracked access}: frames without k accesses sort first
+	using EvictionKey = std::pair<bool, uint64_t>;
+
+	struct FrameHistory {
+		// ring buffer holding the last k access timestamps
+		std::vector<uint64_t> history_;
+		uint32_t next_ {0};
+		uint32_t size_ {0};
+		bool is_evictable_ {false};
+	};
+
+	[[nodiscard]] EvictionKey GetEvictionKey(const FrameHistory &frame) const;
+	void RecordAccess(FrameHistory &frame);
+
+	const uint32_t k_;
+	uint64_t current_timestamp_ {0};
+	std::vector<FrameHistory> frames_;
+	std::set<std::pair<EvictionKey, frame_id_t>> evictable_frames_;
+};
+} // namespace db
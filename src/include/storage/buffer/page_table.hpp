@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common/config.hpp"
+#include "common/page_id.hpp"
+#include "common/typedef.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace db {
+/**
+ * PageTable maps the page ids cached by a buffer pool shard to their frames. It is a flat linear probing table sized
+ * to at least twice the number of frames, so it never has to grow and inserts never allocate. Erase shifts the
+ * following entries back instead of leaving tombstones.
+ * Insert and Erase are called under the shard latch. Find may also be called without it: it never reads out of bounds,
+ * but it can miss an entry that a concurrent Erase is shifting, or return a frame that was just remapped. Lock-free
+ * callers must pin the frame and check its page id, and retry under the latch when the lookup fails.
+ */
+class PageTable {
+public:
+	explicit PageTable(size_t num_frames);
+	PageTable(const PageTable &) = delete;
+	PageTable &operator=(const PageTable &) = delete;
+
+	[[nodiscard]] frame_id_t Find(PageId page_id) const {
+		auto key = page_id.Pack();
+		auto slot = GetHomeSlot(key);
+		for (size_t probes = 0; probes <= mask_; ++probes, slot = (slot + 1) & mask_) {
+			auto slot_key = slots_[slot].key_.load(std::memory_order_acquire);
+			if (slot_key == key) {
+				return slots_[slot].frame_id_.load(std::memory_order_relaxed);
+			}
+			if (slot_key == EMPTY_KEY) {
+				break;
+			}
+		}
+		return INVALID_FRAME_ID;
+	}
+	[[nodiscard]] bool Contains(PageId page_id) const {
+		return Find(page_id) != INVALID_FRAME_ID;
+	}
+	// page_id must not be in the table yet
+	void Insert(PageId page_id, frame_id_t frame_id);
+	bool Erase(PageId page_id);
+
+private:
+	// the packed invalid page id, no cached page ever has it
+	static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+
+	struct Slot {
+		std::atomic<uint64_t> key_ {EMPTY_KEY};
+		std::atomic<frame_id_t> frame_id_ {INVALID_FRAME_ID};
+	};
+
+	[[nodiscard]] size_t GetHomeSlot(uint64_t key) const {
+		// the shard is picked by the low bits of the same hash, so the slot is taken from the high bits
+		return PageIdHash::Mix(key) >> shift_;
+	}
+
+	std::unique_ptr<Slot[]> slots_;
+	size_t mask_;
+	uint32_t shift_;
+};
+} // namespace db
@@ -14,7 +14,11 @@ public:
 	~RandomBogoReplacer() override = default;
 	auto Evict(frame_id_t &frame_id) -> bool override;
 	void Pin(frame_id_t frame_id) override;
+	void PinWithoutAccess(frame_id_t frame_id) override {
+		Pin(frame_id);
+	}
 	void Unpin(frame_id_t frame_id) override;
+	void Remove(frame_id_t frame_id) override;
 	void Print() override {
 		for (const auto &iter : frame_store_) {
 			LOG_TRACE("frame_id: {} is_pinned: {}\n", iter.first, iter.second ? "false" : "true");
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "common/typedef.hpp"
+
+#include <vector>
 namespace db {
+enum class ReplacerType { RANDOM, LRU_K, CLOCK };
+
 class Replacer {
 public:
 	explicit Replacer() = default;
@@ -10,9 +14,20 @@ public:
 	Replacer &operator=(const Replacer &) = delete;
 	Replacer(Replacer &&) = delete;
 	Replacer &operator=(Replacer &&) = delete;
+	// pick a victim and make it not evictable. the frame keeps what the replacer knows about it until Remove, the
+	// caller removes it once the frame is taken and unpins it again if the frame cannot be taken after all
 	virtual auto Evict(frame_id_t &frame_id) -> bool = 0;
+	// record an access to the frame and make it not evictable
 	virtual void Pin(frame_id_t frame_id) = 0;
+	// make the frame not evictable without counting as an access, for internal pins such as flushing
+	virtual void PinWithoutAccess(frame_id_t frame_id) = 0;
+	// make the frame evictable
 	virtual void Unpin(frame_id_t frame_id) = 0;
+	// stop tracking the frame, called when the frame goes back to the free list
+	virtual void Remove(frame_id_t frame_id) = 0;
+	// orders the frames from the hottest to the coldest, replacers without a notion of hotness leave them as they are
+	virtual void SortByHotness([[maybe_unused]] std::vector<frame_id_t> &frames) const {
+	}
 	virtual void Print() = 0;
 };
 } // namespace db
@@ -1,29 +1,213 @@
 #pragma once
 
+#include "common/config.hpp"
 #include "common/page_id.hpp"
 #include "common/typedef.hpp"
+#include "storage/io_engine.hpp"
+#include "storage/tablespace.hpp"
 
-#include <fstream>
-#include <unordered_map>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <utility>
+#include <vector>
 
 namespace db {
 class Catalog; // forward declaration
+class IdleTableFiles;
+
+// adjacent pages of one table file, page i of the run is read into pages_[i]
+struct PageRun {
+	PageId first_page_id_;
+	std::span<char *const> pages_;
+	// pages fully read before the end of the file or an error
+	uint32_t num_read_ {0};
+};
+
+// a table data file, open while fd_ is not -1. the size follows every write, so reads are checked against it without
+// a stat, and it is kept when the file is closed
+struct TableFile {
+	int fd_ {-1};
+	// TableFileRefs to the file, it is only closed without any
+	std::atomic<uint32_t> users_ {0};
+	// the list of the disk manager the file is put on while it has no users, nullptr for a file that is never closed
+	IdleTableFiles *idle_files_ {nullptr};
+	// position in the idle list, guarded by its latch
+	std::list<TableFile *>::iterator idle_pos_;
+	bool is_idle_ {false};
+	std::atomic<size_t> size_ {0};
+	// end of the space reserved with fallocate, at least size_. blocks past size_ are allocated but not part of the
+	// file until a write reaches them
+	std::atomic<size_t> allocated_ {0};
+	// written since the last fdatasync
+	std::atomic<bool> needs_sync_ {false};
+	// alignment o_direct needs of the buffers, 0 if the file goes through the os page cache
+	size_t io_alignment_ {0};
+
+	void Extend(size_t end) {
+		FetchMax(size_, end);
+	}
+	static void FetchMax(std::atomic<size_t> &value, size_t new_value) {
+		auto current = value.load(std::memory_order_relaxed);
+		while (current < new_value && !value.compare_exchange_weak(current, new_value, std::memory_order_release)) {
+		}
+	}
+};
+
+// FILE_PER_TABLE keeps the pages of each table in a data file of its own. TABLESPACE puts the pages of all tables into
+// one file, which keeps the number of open files and the startup checks independent of the number of tables
+enum class StorageLayout : uint8_t { FILE_PER_TABLE, TABLESPACE };
+
+// the open table files without users, the least recently used one at the back. a file goes to the front when its last
+// user lets go and leaves the list when it gets a user again
+class IdleTableFiles {
+public:
+	// called after the users of the file went from or to 0. the users are checked again under the latch, a racing
+	// update of the same file sees the count the other one left
+	void Update(TableFile &file);
+	void Remove(TableFile &file);
+	// takes the least recently used file off the list, nullptr if there is none
+	TableFile *PopLeastRecentlyUsed();
+	void Clear();
+
+private:
+	std::mutex latch_;
+	std::list<TableFile *> files_;
+};
+
+// keeps the fd of a table file open while the io through it is in progress
+class TableFileRef {
+public:
+	explicit TableFileRef(TableFile &file) : file_(&file) {
+		if (file_->users_.fetch_add(1, std::memory_order_relaxed) == 0 && file_->idle_files_ != nullptr) {
+			file_->idle_files_->Update(*file_);
+		}
+	}
+	TableFileRef(TableFileRef &&other) noexcept : file_(std::exchange(other.file_, nullptr)) {
+	}
+	TableFileRef(const TableFileRef &) = delete;
+	TableFileRef &operator=(const TableFileRef &) = delete;
+	TableFileRef &operator=(TableFileRef &&) = delete;
+	~TableFileRef() {
+		if (file_ != nullptr && file_->users_.fetch_sub(1, std::memory_order_release) == 1 &&
+		    file_->idle_files_ != nullptr) {
+			file_->idle_files_->Update(*file_);
+		}
+	}
+	TableFile *operator->() const {
+		return file_;
+	}
+	TableFile &operator*() const {
+		return *file_;
+	}
+
+private:
+	TableFile *file_;
+};
+
+struct FileCacheStats {
+	// table file lookups that found the file open, and the ones that had to open it
+	uint64_t hits_ {0};
+	uint64_t misses_ {0};
+	size_t open_files_ {0};
+};
+
+struct DiskIoStats {
+	// writes issued to the table files, the adjacent pages of a WritePages batch share one
+	uint64_t write_requests_ {0};
+	uint64_t syncs_ {0};
+	// open files with writes that are not durable yet
+	size_t unsynced_files_ {0};
+};
+
+struct DiskManagerConfig {
+	StorageLayout layout_ {StorageLayout::FILE_PER_TABLE};
+	// IO_URING keeps the requests of a batch in flight together, it falls back to blocking io without liburing
+	IoEngineType io_engine_ {IoEngineType::SYNC};
+	// a write past the reserved space of a table file reserves up to the next multiple of it, so the file grows in
+	// few large contiguous allocations instead of a block per page. 0 grows the file with every write
+	size_t extent_size_ {TABLE_FILE_EXTENT_SIZE};
+	// table files kept open at most, the least recently used file nobody does io through is closed to open another.
+	// the bound is exceeded while every open file is in use. 0 keeps every file open until ShutDown
+	size_t max_open_files_ {MAX_OPEN_TABLE_FILES};
+	// opens the table files with O_DIRECT so the pages are only cached by the buffer pool. a file system without
+	// direct io support keeps using the os page cache
+	bool direct_io_ {false};
+};
+
+struct PageWrite {
+	PageId page_id_;
+	const char *data_;
+};
 
 class DiskManager {
 public:
-	explicit DiskManager(Catalog &catalog) : cm_(catalog) {};
+	explicit DiskManager(Catalog &catalog, const DiskManagerConfig &config = {});
 	DiskManager(const DiskManager &) = delete;
 	DiskManager &operator=(const DiskManager &) = delete;
 	;
 	void ShutDown();
+	// writes go to the os page cache, or to the device with direct io. they are durable once Sync or a synced
+	// WritePages returned. a buffer that is not aligned for direct io is copied through an aligned one
 	void WritePage(PageId page_id, const char *page_data);
+	// writes the pages sorted by file and offset, adjacent pages of a file with one vectored write. with sync set every
+	// file the batch wrote to gets one fdatasync before the call returns
+	void WritePages(std::span<const PageWrite> writes, bool sync = false);
+	// makes every write that returned so far durable, with one fdatasync per file written since its last sync
+	void Sync();
 	void ReadPage(PageId page_id, char *page_data);
+	// reads the runs straight into their page buffers, handed to the io engine as one batch. a run that fails is
+	// logged and reports the pages read before the failure
+	void ReadPageRuns(std::span<PageRun> runs);
+	[[nodiscard]] IoEngineType GetIoEngineType() const {
+		return io_engine_->GetType();
+	}
+	// buffer alignment the file of the table needs for direct io, 0 if its io goes through the os page cache
+	size_t GetIoAlignment(table_oid_t table_id);
+	FileCacheStats GetFileCacheStats();
+	DiskIoStats GetIoStats();
 	~DiskManager();
 
 private:
-	void AddTableDataIfNotExist(table_oid_t table_id);
+	// the table's data file, opened or created on first use and reopened after it was closed. an open file is found
+	// with an index into table_files_, only opening it resolves the path through the catalog
+	TableFileRef GetTableFile(table_oid_t table_id);
+	// closes the least recently used open file without users. unsynced writes are synced first with latch_ released, a
+	// closed file never needs a sync. lock holds latch_ exclusively
+	void CloseColdTableFile(std::unique_lock<std::shared_mutex> &lock);
+	// offset of the page in the file of the table, in the tablespace a new extent is allocated for a page outside the
+	// extents of the table
+	off_t GetPageOffset(PageId page_id);
+	// of count pages from page_id on, the number that are adjacent in the file
+	[[nodiscard]] uint32_t GetAdjacentPages(PageId page_id, uint32_t count) const;
+	// preallocates whole extents of the file up to at least end, a no-op while end is within the reserved space
+	void Reserve(TableFile &file, size_t end) const;
+	// grows the size of the file to end after a write, in the tablespace the directory keeps the size of the table
+	void Extend(TableFile &file, table_oid_t table_id, size_t end);
+	// one fdatasync per distinct file, the tables of the tablespace share one
+	void SyncFiles(std::vector<TableFile *> files);
 	Catalog &cm_;
-	std::unordered_map<table_oid_t, std::fstream> table_data_files_;
-	std::unordered_map<table_oid_t, std::fstream> table_meta_files_;
+	std::unique_ptr<IoEngine> io_engine_;
+	size_t extent_size_;
+	bool direct_io_;
+	// the single file of the tablespace layout, nullptr with a file per table
+	std::unique_ptr<Tablespace> tablespace_;
+	size_t tablespace_io_alignment_ {0};
+	// indexed by table oid + 1, the system catalog is at 0. io goes through pread and pwrite at the page offset, there
+	// is no shared cursor and threads read and write the same file concurrently. the latch guards the vector and the
+	// opening and closing of files
+	std::vector<std::unique_ptr<TableFile>> table_files_;
+	std::shared_mutex latch_;
+	size_t max_open_files_;
+	size_t num_open_files_ {0};
+	// only kept with a bound on the open files
+	IdleTableFiles idle_files_;
+	std::atomic<uint64_t> file_cache_hits_ {0};
+	std::atomic<uint64_t> file_cache_misses_ {0};
+	std::atomic<uint64_t> write_requests_ {0};
+	std::atomic<uint64_t> syncs_ {0};
 };
 } // namespace db
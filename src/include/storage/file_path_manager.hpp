@@ -41,10 +41,24 @@ public:
 		return data_path;
 	}
 
+	// data pages of every table in the tablespace layout, and the directory of its extents
+	fs::path GetTablespacePath() {
+		return db_path_ / "tablespace";
+	}
+
+	fs::path GetTablespaceDirectoryPath() {
+		return db_path_ / "tablespace_directory";
+	}
+
 	fs::path GetSystemCatalogPath() {
 		return db_path_ / "system_catalog";
 	}
 
+	// resident pages of a buffer pool at the last shutdown
+	fs::path GetBufferPoolDumpPath(const std::string &pool_name = DEFAULT_BUFFER_POOL) {
+		return db_path_ / ("buffer_pool_pages." + pool_name);
+	}
+
 private:
 	fs::path db_path_;
 	FilePathManager() = default;
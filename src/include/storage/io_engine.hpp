@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <sys/types.h>
+#include <sys/uio.h>
+namespace db {
+enum class IoEngineType : uint8_t { SYNC, IO_URING };
+
+// one positional read or write of a list of buffers
+struct IoRequest {
+	int fd_ {-1};
+	off_t offset_ {0};
+	std::span<const iovec> buffers_;
+	bool is_write_ {false};
+	// bytes transferred or -errno, a read comes back short at the end of the file
+	int64_t result_ {0};
+};
+
+/**
+ * Carries out batches of file io and returns once every request of the batch completed. The sync engine issues the
+ * requests one after another with preadv and pwritev. The io_uring engine is only built when liburing is found, it
+ * keeps up to IO_URING_QUEUE_DEPTH requests of a batch in flight so a device with deep queues serves them in parallel.
+ */
+class IoEngine {
+public:
+	virtual ~IoEngine() = default;
+	virtual void Submit(std::span<IoRequest> requests) = 0;
+	[[nodiscard]] virtual IoEngineType GetType() const = 0;
+
+	// falls back to the sync engine if io_uring is not built in or the kernel does not let us set up a ring
+	static std::unique_ptr<IoEngine> Create(IoEngineType type);
+};
+} // namespace db
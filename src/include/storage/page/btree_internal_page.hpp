@@ -15,6 +15,7 @@ static constexpr int INTERNAL_PAGE_HEADER_SIZE = 32;
 using InternalNode = std::pair<IndexKeyType, InternalValueType>;
 // static constexpr int INTERNAL_MAX_NODE_SIZE = 10;
 static constexpr int INTERNAL_MAX_NODE_SIZE = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(InternalNode);
+static_assert(INTERNAL_MAX_NODE_SIZE <= BTREE_MAX_CHILDREN, "every child slot needs a swizzled reference");
 
 class BtreeInternalPage : public BtreePage {
 
@@ -58,6 +59,11 @@ public:
 	}
 
 	[[nodiscard]] InternalValueType Lookup(const IndexKeyType &key, const Comparator &comparator) const {
+		return ValueAt(LookupSlot(key, comparator));
+	}
+
+	// slot of the child the key leads to
+	[[nodiscard]] idx_t LookupSlot(const IndexKeyType &key, const Comparator &comparator) const {
 
 		LOG_TRACE("Internal page id %d with size %d, parent id %d, max size %d content %s",
 		          static_cast<int>(GetPageId()), static_cast<int>(GetSize()), static_cast<int>(GetParentPageId()),
@@ -70,14 +76,14 @@ public:
 		                     [&comparator](const auto &pair, auto key) { return comparator(pair.first, key) < 0; });
 		// if target is last then lookup key is larger than all keys
 		if (target == node_array_ + GetSize()) {
-			return ValueAt(GetSize() - 1);
+			return GetSize() - 1;
 			// if target is the same as the search key go to that value due our internal
 			// node convention
 		}
 		if (comparator(key, target->first) == 0) {
-			return target->second;
+			return std::distance(node_array_, target);
 		}
-		return std::prev(target)->second;
+		return std::distance(node_array_, target) - 1;
 	}
 
 	void PopulateNewRoot(const InternalValueType &old_value, const IndexKeyType &new_key,
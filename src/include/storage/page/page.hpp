@@ -3,31 +3,37 @@
 #include "common/config.hpp"
 #include "common/page_id.hpp"
 #include "common/rwlatch.hpp"
+#include "storage/buffer/frame_descriptor.hpp"
 #include "fmt/format.h"
 
+#include <atomic>
+#include <cassert>
 #include <cstring>
 
 namespace db {
+/**
+ * Metadata of a buffer frame. The page data lives in the buffer pool's frame arena, data_ points at the frame.
+ */
 class Page {
-	friend class BufferPool;
+	friend class BufferPoolShard;
 
 public:
-	explicit Page() {
-		ResetMemory();
-	}
+	Page() = default;
 
 	Page(const Page &) = delete;
 	Page &operator=(const Page &) = delete;
 	Page(Page &&) = delete;
 	Page &operator=(Page &&) = delete;
 
-	~Page() = default;
+	~Page() {
+		delete[] child_refs_.load(std::memory_order_relaxed);
+	}
 
 	auto GetData() -> char * {
-		return data_.data();
+		return data_;
 	}
 	auto GetPageId() -> PageId {
-		return page_id_;
+		return descriptor_->page_id_.load(std::memory_order_relaxed);
 	}
 
 	template <class T>
@@ -55,20 +61,66 @@ public:
 	void RUnlatch() {
 		rwlatch_.RUnlock();
 	}
+	bool TryRLatch() {
+		return rwlatch_.TryRLock();
+	}
+	// only stable while the caller holds a latch on the page
+	[[nodiscard]] uint64_t GetVersion() const {
+		return rwlatch_.GetVersion();
+	}
+	// true if no writer latched the page since version was read. together with a page id check this tells an
+	// optimistic reader that the frame held the same page all along, the shard bumps the version around a takeover
+	[[nodiscard]] bool ValidateVersion(uint64_t version) const {
+		return rwlatch_.Validate(version);
+	}
+	// direct reference to the frame of the child in the given slot of a b+tree internal node. a reference is only a
+	// hint, it is followed once the child frame is pinned and found to still hold the child page. the references of a
+	// frame are allocated the first time one is asked for and dropped when the frame is handed to another page
+	std::atomic<Page *> &GetChildRef(idx_t slot) {
+		assert(slot < BTREE_MAX_CHILDREN);
+		auto *refs = child_refs_.load(std::memory_order_acquire);
+		if (refs == nullptr) {
+			auto *new_refs = new std::atomic<Page *>[BTREE_MAX_CHILDREN] {};
+			if (child_refs_.compare_exchange_strong(refs, new_refs, std::memory_order_acq_rel)) {
+				refs = new_refs;
+			} else {
+				delete[] new_refs;
+			}
+		}
+		return refs[slot];
+	}
 	[[nodiscard]] std::string ToString() const {
+		auto page_id = descriptor_->page_id_.load();
 		return fmt::format("Page {{ table_id={}, page_id={} is_dirty={}, pin_count={}, data_size={} }}",
-		                   page_id_.table_id_, page_id_.page_number_, is_dirty_, pin_count_, data_.size());
+		                   page_id.table_id_, page_id.page_number_, descriptor_->is_dirty_.load(),
+		                   descriptor_->pin_count_.load(), PAGE_SIZE);
 	}
 
 private:
+	// the frame is locked by the shard and gets new content, nobody holds the latch of a locked frame
+	void BeginReplace() {
+		rwlatch_.BeginReplace();
+	}
+	void EndReplace() {
+		rwlatch_.EndReplace();
+	}
 	void ResetMemory() {
-		std::memset(data_.data(), 0, PAGE_SIZE);
+		std::memset(data_, 0, PAGE_SIZE);
+	}
+	void ResetChildRefs() {
+		auto *refs = child_refs_.load(std::memory_order_relaxed);
+		if (refs == nullptr) {
+			return;
+		}
+		for (idx_t slot = 0; slot < BTREE_MAX_CHILDREN; ++slot) {
+			refs[slot].store(nullptr, std::memory_order_relaxed);
+		}
 	}
-	PageId page_id_;
-	bool is_dirty_ = false;
-	uint16_t pin_count_ = 0;
+	// bookkeeping of the frame in the shard's descriptor array
+	FrameDescriptor *descriptor_ {nullptr};
 	ReaderWriterLatch rwlatch_;
-	std::array<char, PAGE_SIZE> data_ {};
+	char *data_ {nullptr};
+	std::atomic<std::atomic<Page *> *> child_refs_ {nullptr};
 };
 } // namespace db
 
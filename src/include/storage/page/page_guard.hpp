@@ -84,6 +84,37 @@ public:
 private:
 	BasicPageGuard guard_;
 };
+/**
+ * OptimisticReadGuard reads a page in its frame without a pin and without taking its shared latch. It remembers the
+ * latch version it started at, the frame may be written or handed to another page meanwhile, so anything read through
+ * the guard is only to be trusted once Validate confirmed that the frame still holds the page at that version. A guard
+ * that started while a writer held the latch never validates.
+ */
+class OptimisticReadGuard {
+public:
+	OptimisticReadGuard(Page &page, PageId page_id);
+	[[nodiscard]] uint64_t GetVersion() const {
+		return version_;
+	}
+	// true if the frame held the page all along and no writer latched it since the guard started
+	[[nodiscard]] bool Validate() const {
+		return !ReaderWriterLatch::IsWriteLocked(version_) && page_->GetPageId() == page_id_ &&
+		       page_->ValidateVersion(version_);
+	}
+	// the frame the guard reads from
+	[[nodiscard]] Page &GetPage() const {
+		return *page_;
+	}
+	template <class T>
+	[[nodiscard]] const T &As() const {
+		return reinterpret_cast<const T &>(*page_->GetData());
+	}
+
+private:
+	Page *page_;
+	PageId page_id_;
+	uint64_t version_;
+};
 class ReadPageGuard {
 public:
 	ReadPageGuard() = default;
@@ -19,7 +19,8 @@ public:
 	// doesn't ensure the tuple is the same schema as the table
 	[[nodiscard]] std::optional<RID> InsertTuple(const TupleMeta &meta, const Tuple &tuple);
 	void UpdateTupleMeta(const TupleMeta &meta, RID rid);
-	[[nodiscard]] std::optional<std::pair<TupleMeta, Tuple>> GetTuple(RID rid) const;
+	[[nodiscard]] std::optional<std::pair<TupleMeta, Tuple>> GetTuple(RID rid,
+	                                                                  BufferAccessStrategy *strategy = nullptr) const;
 	[[nodiscard]] TupleMeta GetTupleMeta(RID rid);
 	[[nodiscard]] page_id_t GetFirstPageId() const;
 	[[nodiscard]] TableIterator MakeIterator();
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "common/config.hpp"
 #include "common/rid.hpp"
+#include "storage/buffer/buffer_access_strategy.hpp"
 #include "storage/table/tuple.hpp"
 
 #include <cassert>
+#include <memory>
 #include <utility>
 
 namespace db {
@@ -22,8 +25,9 @@ public:
 	TableIterator(TableIterator &&) = delete;
 	TableIterator &operator=(TableIterator &&) = delete;
 
-	TableIterator(const TableHeap &table_heap, RID rid, RID stop_at_rid)
-	    : table_heap_(table_heap), rid_(rid), stop_at_rid_(stop_at_rid) {};
+	TableIterator(const TableHeap &table_heap, RID rid, RID stop_at_rid,
+	              std::unique_ptr<BufferAccessStrategy> strategy = nullptr)
+	    : table_heap_(table_heap), rid_(rid), stop_at_rid_(stop_at_rid), strategy_(std::move(strategy)) {};
 
 	~TableIterator() = default;
 
@@ -36,9 +40,16 @@ public:
 	auto operator++() -> TableIterator &;
 
 private:
+	// called when the cursor moves from prev_page_number to page_number
+	void ReadAhead(page_id_t prev_page_number, page_id_t page_number);
+
 	const TableHeap &table_heap_;
 	RID rid_;
 	RID stop_at_rid_;
+	// set for scans large enough to flush the buffer pool, keeps their pages in a small ring of frames
+	std::unique_ptr<BufferAccessStrategy> strategy_;
+	// last page number requested by read-ahead
+	page_id_t read_ahead_end_ {INVALID_PAGE_ID};
 };
 
 } // namespace db
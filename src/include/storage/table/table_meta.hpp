@@ -26,6 +26,7 @@ struct TableMeta {
 		serializer.WriteProperty(103, "last_table_data_page_id", last_table_data_page_id_);
 		serializer.WriteProperty(104, "last_table_heap_data_page_id", last_table_heap_data_page_id_);
 		serializer.WriteProperty(105, "tuple_count", tuple_count_);
+		serializer.WritePropertyWithDefault(106, "buffer_pool", buffer_pool_, std::string(HEAP_BUFFER_POOL));
 	}
 
 	[[nodiscard]] static std::unique_ptr<TableMeta> Deserialize(Deserializer &deserializer) {
@@ -36,6 +37,7 @@ struct TableMeta {
 		deserializer.ReadProperty(103, "last_table_data_page_id", meta->last_table_data_page_id_);
 		deserializer.ReadProperty(104, "last_table_heap_data_page_id", meta->last_table_heap_data_page_id_);
 		deserializer.ReadProperty(105, "tuple_count", meta->tuple_count_);
+		deserializer.ReadPropertyWithDefault(106, "buffer_pool", meta->buffer_pool_, std::string(HEAP_BUFFER_POOL));
 		return meta;
 	}
 
@@ -71,9 +73,9 @@ struct TableMeta {
 
 	std::string ToString() const {
 		return fmt::format("TableMeta(name: {}, table_oid: {}, schema: {}, last_table_data_page_id: {}, "
-		                   "last_table_heap_data_page_id: {}, tuple_count: {})",
+		                   "last_table_heap_data_page_id: {}, tuple_count: {}, buffer_pool: {})",
 		                   name_, table_oid_, schema_.ToString(), last_table_data_page_id_,
-		                   last_table_heap_data_page_id_, tuple_count_);
+		                   last_table_heap_data_page_id_, tuple_count_, buffer_pool_);
 	}
 	Schema schema_;
 	std::string name_;
@@ -90,6 +92,8 @@ struct TableMeta {
 	page_id_t last_table_heap_data_page_id_ {INVALID_PAGE_ID};
 
 	uint64_t tuple_count_ {0};
+	// name of the buffer pool the heap pages are cached in
+	std::string buffer_pool_ {HEAP_BUFFER_POOL};
 	std::mutex latch_;
 };
 } // namespace db
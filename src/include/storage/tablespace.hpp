@@ -0,0 +1,87 @@
+#pragma once
+
+#include "common/config.hpp"
+#include "common/page_id.hpp"
+#include "common/typedef.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <sys/types.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace db {
+/**
+ * Tablespace keeps the data pages of all tables in one file made of extents of TABLESPACE_EXTENT_PAGES pages. Pages
+ * of a table are contiguous within an extent, the extent directory maps every extent of a table to the physical one
+ * it was given. Physical extents are handed out in order and never move, so the directory is a versioned header
+ * followed by entries where entry i names the table and the extent of the table stored at physical extent i, and
+ * allocating an extent appends one entry. The entry of the extent a table ends in also counts the pages of the table
+ * in it, which gives the size of the table when the tablespace is opened again. Sizes are kept in memory as tables
+ * grow and their entries are written by SyncDirectory, which has to run before the data is synced anyway.
+ */
+class Tablespace {
+public:
+	static constexpr size_t EXTENT_SIZE = static_cast<size_t>(TABLESPACE_EXTENT_PAGES) * PAGE_SIZE;
+
+	Tablespace(const std::filesystem::path &data_path, const std::filesystem::path &directory_path);
+	Tablespace(const Tablespace &) = delete;
+	Tablespace &operator=(const Tablespace &) = delete;
+	~Tablespace();
+
+	[[nodiscard]] int GetFd() const {
+		return fd_;
+	}
+	// file offset of the page. a page in an extent the table has not used yet gets a new extent with allocate set,
+	// otherwise the offset is -1
+	off_t Locate(PageId page_id, bool allocate);
+	// end of the last page written to the table
+	size_t GetSize(table_oid_t table_id);
+	// records that the table was written up to end, which lies in an extent of the table
+	void Extend(table_oid_t table_id, size_t end);
+	// writes the sizes of the tables that grew and makes the directory durable, before the data it locates is synced
+	void SyncDirectory();
+
+private:
+	struct DirectoryHeader {
+		std::array<char, 8> magic_;
+		uint32_t version_;
+		uint32_t reserved_;
+	};
+	static constexpr std::array<char, 8> DIRECTORY_MAGIC {'G', 'D', 'B', 'T', 'S', 'D', 'I', 'R'};
+	// bumped on every change of the directory layout, a directory of another version is not opened
+	static constexpr uint32_t DIRECTORY_VERSION = 1;
+
+	struct DirectoryEntry {
+		table_oid_t table_id_;
+		uint32_t extent_;
+		// pages of the extent up to the last one written, while the table ends in it
+		uint32_t num_pages_;
+	};
+	static constexpr uint32_t UNALLOCATED_EXTENT = UINT32_MAX;
+
+	void ReadDirectory(const std::filesystem::path &directory_path);
+	off_t AllocateExtent(table_oid_t table_id, uint32_t extent);
+	void WriteEntry(uint32_t physical_extent, const DirectoryEntry &entry);
+	// the entries of the extents the resized tables end in, the latch has to be held
+	std::vector<std::pair<uint32_t, DirectoryEntry>> TakeResizedEntries();
+
+	int fd_ {-1};
+	int directory_fd_ {-1};
+	// physical extent of every extent of a table, UNALLOCATED_EXTENT for the gaps
+	std::unordered_map<table_oid_t, std::vector<uint32_t>> extents_;
+	std::unordered_map<table_oid_t, size_t> sizes_;
+	// tables whose size changed since their entry was last written
+	std::unordered_set<table_oid_t> resized_tables_;
+	uint32_t num_extents_ {0};
+	bool directory_needs_sync_ {false};
+	std::shared_mutex latch_;
+	// one directory sync at a time, the entries are written without holding latch_
+	std::mutex sync_latch_;
+};
+} // namespace db
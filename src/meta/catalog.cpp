@@ -10,7 +10,8 @@
 
 namespace db {
 
-std::optional<table_oid_t> Catalog::CreateTable(const std::string &table_name, const Schema &schema) {
+std::optional<table_oid_t> Catalog::CreateTable(const std::string &table_name, const Schema &schema,
+                                                const std::string &buffer_pool) {
 	if (table_names_.contains(table_name)) {
 		return std::nullopt;
 	}
@@ -18,12 +19,15 @@ std::optional<table_oid_t> Catalog::CreateTable(const std::string &table_name, c
 	table_names_.emplace(table_name, table_oid);
 
 	auto table_meta = std::make_unique<TableMeta>(schema, table_name, table_oid);
+	table_meta->buffer_pool_ = buffer_pool;
 
 	tables_.insert({table_oid, std::move(table_meta)});
 	index_names_.emplace(table_name, std::unordered_map<std::string, index_oid_t> {});
 
 	CreateFileIfNotExists(FilePathManager::GetInstance().GetTableMetaPath(table_name));
-	CreateFileIfNotExists(FilePathManager::GetInstance().GetTableDataPath(table_name));
+	if (layout_ == StorageLayout::FILE_PER_TABLE) {
+		CreateFileIfNotExists(FilePathManager::GetInstance().GetTableDataPath(table_name));
+	}
 	PersistToDisk();
 	// create table data and meta files
 	return table_oid;
@@ -31,7 +35,7 @@ std::optional<table_oid_t> Catalog::CreateTable(const std::string &table_name, c
 
 std::optional<index_oid_t> Catalog::CreateIndex(const std::string &index_name, const std::string &table_name,
                                                        const Column &key_col, bool is_primary_key, IndexType index_type,
-                                                       BufferPool &bpm) {
+                                                       BufferPoolSet &buffer_pools, const std::string &buffer_pool) {
 	if (table_names_.find(table_name) == table_names_.end()) {
 		return std::nullopt;
 	}
@@ -46,11 +50,12 @@ std::optional<index_oid_t> Catalog::CreateIndex(const std::string &index_name, c
 	// IndexMeta(std::string name, table_oid_t table_id, Column key_col, IndexConstraintType index_constraint_type)
 	IndexConstraintType constraint_type = is_primary_key ? IndexConstraintType::PRIMARY : IndexConstraintType::NONE;
 	auto index_meta = std::make_unique<IndexMeta>(index_name, table_id, key_col, constraint_type, index_type);
+	index_meta->buffer_pool_ = buffer_pool;
 
 	std::unique_ptr<Index> index;
 	const auto &table_meta = tables_.at(table_names_.at(table_name));
 	if (index_type == IndexType::BPlusTreeIndex) {
-		auto btree_index = std::make_unique<BTreeIndex>(*index_meta, *table_meta, bpm);
+		auto btree_index = std::make_unique<BTreeIndex>(*index_meta, *table_meta, buffer_pools.GetPool(buffer_pool));
 	} else {
 		throw NotImplementedException("Unsupported index type");
 	}
@@ -14,7 +14,7 @@ bool InsertExecutor::Next(Tuple &tuple, RID &rid) {
 	RID r;
 
 	auto &table_meta = exec_ctx_.GetCatalog().GetTable(plan_->GetTableOid());
-	auto table_heap = std::make_unique<TableHeap>(exec_ctx_.GetBufferPoolManager(), table_meta);
+	auto table_heap = std::make_unique<TableHeap>(exec_ctx_.GetBufferPool(table_meta), table_meta);
 	LOG_TRACE("created table heap");
 
 	while (child_executor_->Next(t, r)) {
@@ -0,0 +1,92 @@
+#include "storage/buffer/background_writer.hpp"
+
+#include "common/logger.hpp"
+#include "storage/buffer/buffer_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace db {
+namespace {
+bool PageIdLess(const PageId &a, const PageId &b) {
+	return std::tie(a.table_id_, a.page_number_) < std::tie(b.table_id_, b.page_number_);
+}
+} // namespace
+
+BackgroundWriter::BackgroundWriter(BufferPool &bpm, BackgroundWriterConfig config)
+    : bpm_(bpm), config_(config), thread_([this] { Run(); }) {
+}
+
+BackgroundWriter::~BackgroundWriter() {
+	Stop();
+}
+
+void BackgroundWriter::Stop() {
+	{
+		std::lock_guard<std::mutex> lock(latch_);
+		stop_ = true;
+	}
+	cv_.notify_one();
+	if (thread_.joinable()) {
+		thread_.join();
+	}
+}
+
+void BackgroundWriter::NotifyDirty(size_t num_dirty_pages) {
+	if (num_dirty_pages < config_.dirty_page_watermark_) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(latch_);
+		wake_up_ = true;
+	}
+	cv_.notify_one();
+}
+
+size_t BackgroundWriter::RunRound() {
+	auto dirty_pages = bpm_.CollectDirtyPages();
+	std::sort(dirty_pages.begin(), dirty_pages.end(), PageIdLess);
+	// resume after the last written page so low page ids do not starve the rest
+	auto start = std::upper_bound(dirty_pages.begin(), dirty_pages.end(), cursor_, PageIdLess);
+	std::rotate(dirty_pages.begin(), start, dirty_pages.end());
+
+	size_t num_written = 0;
+	size_t next = 0;
+	// latched pages are skipped, the next batch makes up for them
+	while (num_written < config_.max_pages_per_round_ && next < dirty_pages.size()) {
+		auto batch_size = std::min(config_.max_pages_per_round_ - num_written, dirty_pages.size() - next);
+		auto batch = std::span<const PageId>(dirty_pages).subspan(next, batch_size);
+		auto is_flushed = bpm_.FlushPages(batch, false);
+		for (size_t i = 0; i < batch.size(); ++i) {
+			if (is_flushed[i] != 0) {
+				num_written++;
+				cursor_ = batch[i];
+			}
+		}
+		next += batch_size;
+	}
+	return num_written;
+}
+
+void BackgroundWriter::Run() {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(latch_);
+			cv_.wait_for(lock, config_.interval_, [this] { return stop_ || wake_up_; });
+			if (stop_) {
+				return;
+			}
+			wake_up_ = false;
+		}
+		try {
+			RunRound();
+		} catch (const std::exception &e) {
+			// the page stays dirty and is retried by the next round or written on eviction
+			LOG_ERROR("Background writer round failed: {}", e.what());
+		}
+	}
+}
+} // namespace db
@@ -1,171 +1,421 @@
-
 #include "storage/buffer/buffer_pool.hpp"
 
 #include "common/config.hpp"
+#include "common/exception.hpp"
 #include "common/logger.hpp"
-#include "storage/buffer/random_replacer.h"
 #include "storage/page/page_guard.hpp"
 #include "storage/page_allocator.hpp"
+#include "storage/serializer/binary_deserializer.hpp"
+#include "storage/serializer/binary_serializer.hpp"
+#include "storage/serializer/file_stream.hpp"
+#include "storage/serializer/memory_stream.hpp"
 
+#include <algorithm>
 #include <cassert>
-#include <memory>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <filesystem>
 #include <mutex>
-#include <vector>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
 namespace db {
-BufferPool::BufferPool(frame_id_t pool_size, DiskManager &disk_manager)
-    : pool_size_(pool_size), replacer_(std::make_unique<RandomBogoReplacer>()), disk_manager_(disk_manager),
-      pages_(pool_size) {
-	for (frame_id_t i = 0; i < pool_size_; ++i) {
-		free_list_.emplace_back(i);
+BufferPool::BufferPool(frame_id_t pool_size, DiskManager &disk_manager, ReplacerType replacer_type,
+                       uint32_t num_shards, frame_id_t max_pool_size, bool use_huge_pages)
+    : pool_size_(pool_size), max_pool_size_(std::max(pool_size, max_pool_size)), disk_manager_(disk_manager),
+      arena_(max_pool_size_, use_huge_pages) {
+	if (num_shards == 0) {
+		num_shards = PickNumShards(pool_size);
+	}
+	assert(pool_size >= static_cast<frame_id_t>(num_shards) && "every shard needs at least one frame");
+	shards_.reserve(num_shards);
+	size_t first_arena_frame = 0;
+	for (uint32_t i = 0; i < num_shards; ++i) {
+		// spread the remainder over the first shards
+		frame_id_t shard_size = pool_size / num_shards + (i < pool_size % num_shards ? 1 : 0);
+		frame_id_t max_shard_size = max_pool_size_ / num_shards + (i < max_pool_size_ % num_shards ? 1 : 0);
+		shards_.emplace_back(std::make_unique<BufferPoolShard>(shard_size, max_shard_size, arena_, first_arena_frame,
+		                                                       disk_manager, replacer_type));
+		first_arena_frame += max_shard_size;
 	}
 }
 
-bool BufferPool::AllocateFrame(frame_id_t &frame_id) {
-	if (free_list_.empty()) {
-		// gotta evict a random frame because
-		if (!replacer_->Evict(frame_id)) {
-			replacer_->Print();
-			return false;
-		}
-		assert(pages_[frame_id].pin_count_ == 0);
-		assert(pages_[frame_id].page_id_.page_number_ >= 0);
-		if (pages_[frame_id].is_dirty_) {
-			auto &evict_page = pages_[frame_id];
-			disk_manager_.WritePage(evict_page.GetPageId(), evict_page.GetData());
-		}
-		pages_[frame_id].ResetMemory();
-		return true;
+BufferPool::~BufferPool() {
+	// the writer flushes through the shards, stop it before they go away
+	StopBackgroundWriter();
+}
+
+void BufferPool::StartBackgroundWriter(BackgroundWriterConfig config) {
+	assert(background_writer_ == nullptr && "background writer is already running");
+	background_writer_ = std::make_unique<BackgroundWriter>(*this, config);
+}
+
+void BufferPool::StopBackgroundWriter() {
+	background_writer_.reset();
+}
+
+uint32_t BufferPool::PickNumShards(frame_id_t pool_size) {
+	uint32_t num_cores = std::max(1U, std::thread::hardware_concurrency());
+	uint32_t max_shards = std::max(1U, static_cast<uint32_t>(pool_size) / BUFFER_POOL_MIN_SHARD_SIZE);
+	return std::min(num_cores, max_shards);
+}
+
+frame_id_t BufferPool::GetShardSize(frame_id_t pool_size, size_t shard_idx) const {
+	auto num_shards = static_cast<frame_id_t>(shards_.size());
+	return pool_size / num_shards + (static_cast<frame_id_t>(shard_idx) < pool_size % num_shards ? 1 : 0);
+}
+
+frame_id_t BufferPool::Resize(frame_id_t pool_size, std::chrono::milliseconds timeout) {
+	if (pool_size < static_cast<frame_id_t>(shards_.size()) || pool_size > max_pool_size_) {
+		throw RuntimeException(fmt::format("Buffer pool size {} out of range [{}, {}]", pool_size, shards_.size(),
+		                                   max_pool_size_));
+	}
+	std::lock_guard<std::mutex> lock(resize_latch_);
+	auto deadline = std::chrono::steady_clock::now() + timeout;
+	frame_id_t new_pool_size = 0;
+	for (size_t i = 0; i < shards_.size(); ++i) {
+		new_pool_size += shards_[i]->Resize(GetShardSize(pool_size, i), deadline);
 	}
-	frame_id = free_list_.front();
-	free_list_.pop_front();
-	return true;
+	pool_size_ = new_pool_size;
+	if (new_pool_size != pool_size) {
+		LOG_WARN("Shrunk buffer pool to {} frames rather than {}, the other frames stayed pinned", new_pool_size,
+		         pool_size);
+	} else {
+		LOG_INFO("Resized buffer pool to {} frames", pool_size);
+	}
+	return new_pool_size;
 }
 
-Page &BufferPool::NewPage(PageAllocator &page_allocator, PageId &page_id) {
-	std::lock_guard<std::mutex> lock(latch_);
-	frame_id_t frame_id = -1;
-	if (!AllocateFrame(frame_id)) {
-		throw std::runtime_error("Failed to allocate frame");
-		// return nullptr;
-	}
-	// assert that frame id is not in the free list
-	assert(std::find(free_list_.begin(), free_list_.end(), frame_id) == free_list_.end() &&
-	       "frame id should not be in the free list");
-	// assert that frame id is valid
-	assert(frame_id != -1 && "frame id has to be assigned a valid value here");
-
-	replacer_->Pin(frame_id);
-
-	// get rid fo the stale page table record
-	auto page_id_to_replace = pages_[frame_id].page_id_;
-	page_table_.erase(page_id_to_replace);
-
-	// assign passed in page_id to the new page
-	// page_id = AllocatePage(page_id.table_id_);
-	page_id = page_allocator.AllocatePage();
-	page_table_[page_id] = frame_id;
-	assert(page_table_.at(page_id) == frame_id && "page table should have the new page id");
-	assert(page_table_.contains(page_id_to_replace) == false && "page table should not have the old page id");
-	// reset the memory and metadata for the new page
-	Page &page = pages_[frame_id];
-	page.page_id_ = page_id;
-	page.pin_count_ = 1;
-	page.is_dirty_ = false;
-	page.ResetMemory();
+size_t BufferPool::GetShardIndex(PageId page_id) const {
+	return PageIdHash {}(page_id) % shards_.size();
+}
 
+BufferPoolShard &BufferPool::GetShard(PageId page_id) {
+	return *shards_[GetShardIndex(page_id)];
+}
+
+std::unique_ptr<BufferAccessStrategy> BufferPool::MakeBulkReadStrategy() const {
+	return std::make_unique<BufferAccessStrategy>(shards_.size(), BULK_READ_RING_SIZE);
+}
+
+Page &BufferPool::NewPage(PageAllocator &page_allocator, PageId &page_id) {
+	// the shard is picked from the page id, so it has to be allocated first
+	{
+		std::lock_guard<std::mutex> lock(allocation_latch_);
+		page_id = page_allocator.AllocatePage();
+	}
+	auto &page = GetShard(page_id).NewPage(page_id);
+	// new pages start out dirty
+	if (background_writer_ != nullptr) {
+		background_writer_->NotifyDirty(GetNumDirtyPages());
+	}
 	return page;
 }
 
-Page &BufferPool::FetchPage(PageId page_id) {
-	assert(page_id.page_number_ != INVALID_PAGE_ID && "page number should be valid");
-	std::lock_guard<std::mutex> lock(latch_);
-	if (page_table_.find(page_id) != page_table_.end()) {
-		frame_id_t frame_id = page_table_[page_id];
-		Page &page = pages_[frame_id];
-		page.pin_count_++;
-		replacer_->Pin(frame_id);
-		return page;
+Page &BufferPool::FetchPage(PageId page_id, BufferAccessStrategy *strategy) {
+	auto shard_idx = GetShardIndex(page_id);
+	auto *ring = strategy != nullptr ? &strategy->GetRing(shard_idx) : nullptr;
+	return shards_[shard_idx]->FetchPage(page_id, ring);
+}
+
+void BufferPool::PrefetchPages(PageId first_page_id, uint32_t num_pages, BufferAccessStrategy *strategy) {
+	// claim every frame before reading so concurrent fetches of these pages wait for the read instead of issuing theirs
+	std::vector<Page *> claimed;
+	for (uint32_t i = 0; i < num_pages; ++i) {
+		PageId page_id {first_page_id.table_id_, first_page_id.page_number_ + static_cast<page_id_t>(i)};
+		auto shard_idx = GetShardIndex(page_id);
+		auto *ring = strategy != nullptr ? &strategy->GetRing(shard_idx) : nullptr;
+		if (auto *page = shards_[shard_idx]->ClaimForPrefetch(page_id, ring); page != nullptr) {
+			claimed.push_back(page);
+		}
+	}
+	auto is_read = ReadClaimedPages(claimed);
+	// pages past the end of the file are handed back
+	for (size_t i = 0; i < claimed.size(); ++i) {
+		GetShard(claimed[i]->GetPageId()).FinishPrefetch(*claimed[i], is_read[i] != 0);
 	}
+	metrics_.RecordPrefetch(std::count(is_read.begin(), is_read.end(), 1));
+}
 
-	frame_id_t frame_id = -1;
-	if (!AllocateFrame(frame_id)) {
-		throw std::runtime_error("Failed to allocate frame");
-		// return nullptr;
+std::vector<uint8_t> BufferPool::ReadClaimedPages(std::span<Page *const> pages) {
+	// every run of adjacent pages becomes one vectored read straight into the frames, the runs go out as one batch
+	std::vector<char *> frames(pages.size());
+	std::vector<PageRun> runs;
+	std::vector<size_t> run_begins;
+	size_t run_begin = 0;
+	while (run_begin < pages.size()) {
+		auto run_page_id = pages[run_begin]->GetPageId();
+		auto run_end = run_begin + 1;
+		auto is_next_page = [&](PageId page_id) {
+			auto page_number = run_page_id.page_number_ + static_cast<page_id_t>(run_end - run_begin);
+			return page_id == PageId {run_page_id.table_id_, page_number};
+		};
+		while (run_end < pages.size() && is_next_page(pages[run_end]->GetPageId())) {
+			run_end++;
+		}
+		for (auto i = run_begin; i < run_end; ++i) {
+			frames[i] = pages[i]->GetData();
+		}
+		runs.push_back({run_page_id, std::span<char *const>(frames).subspan(run_begin, run_end - run_begin)});
+		run_begins.push_back(run_begin);
+		run_begin = run_end;
 	}
-	assert(frame_id != -1 && "frame id has to be assigned a valid value here");
 
-	page_table_.erase(pages_[frame_id].page_id_);
-	page_table_.insert({page_id, frame_id});
+	std::vector<uint8_t> is_read(pages.size(), 0);
+	try {
+		auto start = std::chrono::steady_clock::now();
+		disk_manager_.ReadPageRuns(runs);
+		// the runs were in flight together, each is charged the time of the batch
+		auto latency = std::chrono::steady_clock::now() - start;
+		for (size_t i = 0; i < runs.size(); ++i) {
+			metrics_.RecordRead(latency);
+			std::fill_n(is_read.begin() + static_cast<std::ptrdiff_t>(run_begins[i]), runs[i].num_read_, 1);
+		}
+	} catch (const std::exception &e) {
+		LOG_WARN("read of {} pages failed: {}", pages.size(), e.what());
+	}
+	return is_read;
+}
 
-	Page &page = pages_[frame_id];
-	page.page_id_ = page_id;
-	page.pin_count_++;
-	page.is_dirty_ = false;
-	disk_manager_.ReadPage(page_id, page.GetData());
+std::vector<BasicPageGuard> BufferPool::FetchPages(std::span<const PageId> page_ids, BufferAccessStrategy *strategy) {
+	// group the batch by shard so every shard is latched once
+	std::vector<std::vector<size_t>> shard_batches(shards_.size());
+	for (size_t i = 0; i < page_ids.size(); ++i) {
+		shard_batches[GetShardIndex(page_ids[i])].push_back(i);
+	}
+	std::vector<BasicPageGuard> guards(page_ids.size());
+	std::vector<uint8_t> is_pinned(page_ids.size(), 0);
+	std::vector<Page *> claimed;
+	std::vector<PageId> batch_page_ids;
+	std::vector<Page *> batch_pages;
+	std::vector<uint8_t> batch_is_claimed;
+	for (size_t shard_idx = 0; shard_idx < shards_.size(); ++shard_idx) {
+		const auto &batch = shard_batches[shard_idx];
+		if (batch.empty()) {
+			continue;
+		}
+		batch_page_ids.clear();
+		for (auto i : batch) {
+			batch_page_ids.push_back(page_ids[i]);
+		}
+		batch_pages.assign(batch.size(), nullptr);
+		batch_is_claimed.assign(batch.size(), 0);
+		auto *ring = strategy != nullptr ? &strategy->GetRing(shard_idx) : nullptr;
+		shards_[shard_idx]->PinOrClaim(batch_page_ids, batch_pages, batch_is_claimed, ring);
+		for (size_t j = 0; j < batch.size(); ++j) {
+			if (batch_is_claimed[j] != 0) {
+				claimed.push_back(batch_pages[j]);
+			} else if (batch_pages[j] != nullptr) {
+				guards[batch[j]] = {*this, *batch_pages[j]};
+				is_pinned[batch[j]] = 1;
+			}
+		}
+	}
 
-	return page;
+	// all misses of the batch in file order, adjacent pages are read together
+	std::sort(claimed.begin(), claimed.end(),
+	          [](Page *lhs, Page *rhs) { return lhs->GetPageId().Pack() < rhs->GetPageId().Pack(); });
+	auto is_read = ReadClaimedPages(claimed);
+	for (size_t i = 0; i < claimed.size(); ++i) {
+		GetShard(claimed[i]->GetPageId()).FinishPrefetch(*claimed[i], is_read[i] != 0, true);
+	}
+	std::unordered_map<PageId, Page *, PageIdHash> loaded;
+	for (size_t i = 0; i < claimed.size(); ++i) {
+		if (is_read[i] != 0) {
+			loaded.emplace(claimed[i]->GetPageId(), claimed[i]);
+		}
+	}
+
+	// every pin is owned by a guard before a fetch below can throw, the guards then unpin what the batch got
+	for (size_t i = 0; i < page_ids.size(); ++i) {
+		if (auto it = loaded.find(page_ids[i]); it != loaded.end() && it->second != nullptr) {
+			guards[i] = {*this, *it->second};
+			is_pinned[i] = 1;
+			it->second = nullptr;
+		}
+	}
+	// pages that were in flight elsewhere, duplicates and failed reads go through the regular path
+	for (size_t i = 0; i < page_ids.size(); ++i) {
+		if (is_pinned[i] == 0) {
+			guards[i] = {*this, FetchPage(page_ids[i], strategy)};
+		}
+	}
+	return guards;
+}
+
+bool BufferPool::IsResident(PageId page_id) {
+	return GetShard(page_id).IsResident(page_id);
 }
 
 bool BufferPool::UnpinPage(PageId page_id, bool is_dirty) {
-	assert(page_id.page_number_ != INVALID_PAGE_ID);
-	std::lock_guard<std::mutex> lock(latch_);
-	if (page_table_.find(page_id) == page_table_.end()) {
-		LOG_ERROR("Page %s not found in page table", page_id.ToString().c_str());
-		assert(false);
-		return false;
+	auto unpinned = GetShard(page_id).UnpinPage(page_id, is_dirty);
+	if (is_dirty && background_writer_ != nullptr) {
+		background_writer_->NotifyDirty(GetNumDirtyPages());
 	}
-	frame_id_t frame_id = page_table_[page_id];
-	Page &page = pages_[frame_id];
-	if (is_dirty) {
-		page.is_dirty_ = true;
+	return unpinned;
+}
+
+bool BufferPool::UnpinPage(Page &page, bool is_dirty) {
+	auto unpinned = GetShard(page.GetPageId()).UnpinPage(page, is_dirty);
+	if (is_dirty && background_writer_ != nullptr) {
+		background_writer_->NotifyDirty(GetNumDirtyPages());
 	}
-	if (page.pin_count_ == 0) {
-		return false;
+	return unpinned;
+}
+
+bool BufferPool::FlushPage(PageId page_id, bool wait_for_latch) {
+	return GetShard(page_id).FlushPage(page_id, wait_for_latch);
+}
+
+std::vector<PageId> BufferPool::CollectDirtyPages() {
+	std::vector<PageId> dirty_pages;
+	for (auto &shard : shards_) {
+		auto shard_dirty_pages = shard->CollectDirtyPages();
+		dirty_pages.insert(dirty_pages.end(), shard_dirty_pages.begin(), shard_dirty_pages.end());
 	}
-	page.pin_count_--;
-	assert(page.pin_count_ >= 0);
-	if (page.pin_count_ == 0) {
-		replacer_->Unpin(frame_id);
+	return dirty_pages;
+}
+
+BufferPoolMetricsSnapshot BufferPool::GetMetrics() const {
+	auto snapshot = metrics_.Snapshot();
+	for (const auto &shard : shards_) {
+		snapshot.Merge(shard->GetMetrics().Snapshot());
+	}
+	return snapshot;
+}
+
+size_t BufferPool::GetNumDirtyPages() const {
+	size_t num_dirty_pages = 0;
+	for (const auto &shard : shards_) {
+		num_dirty_pages += shard->GetNumDirtyPages();
 	}
-	return true;
+	return num_dirty_pages;
 }
 
-bool BufferPool::FlushPage(PageId page_id) {
-	std::lock_guard<std::mutex> lock(latch_);
-	if (page_table_.find(page_id) == page_table_.end()) {
-		return false;
+std::vector<uint8_t> BufferPool::FlushPages(std::span<const PageId> page_ids, bool wait_for_latch) {
+	std::vector<size_t> order(page_ids.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(),
+	          [&](size_t lhs, size_t rhs) { return page_ids[lhs].Pack() < page_ids[rhs].Pack(); });
+	std::vector<uint8_t> is_flushed(page_ids.size(), 0);
+	std::vector<size_t> skipped;
+	std::vector<Page *> pages;
+	std::vector<PageWrite> writes;
+	std::vector<size_t> written;
+	for (size_t batch_begin = 0; batch_begin < order.size(); batch_begin += FLUSH_BATCH_PAGES) {
+		auto batch_end = std::min(order.size(), batch_begin + FLUSH_BATCH_PAGES);
+		pages.clear();
+		writes.clear();
+		written.clear();
+		for (auto i = batch_begin; i < batch_end; ++i) {
+			auto page_id = page_ids[order[i]];
+			// waiting for a latch while holding the ones of the batch could deadlock with a writer crabbing through
+			// them, a latched page is waited for on its own after the batch
+			auto *page = GetShard(page_id).BeginFlush(page_id, false);
+			if (page == nullptr) {
+				skipped.push_back(order[i]);
+				continue;
+			}
+			pages.push_back(page);
+			writes.push_back({page_id, page->GetData()});
+			written.push_back(order[i]);
+		}
+		if (writes.empty()) {
+			continue;
+		}
+		std::exception_ptr error;
+		auto start = std::chrono::steady_clock::now();
+		try {
+			disk_manager_.WritePages(writes);
+		} catch (...) {
+			error = std::current_exception();
+		}
+		// the writes were in flight together, each is charged the time of the batch
+		auto latency = std::chrono::steady_clock::now() - start;
+		for (size_t j = 0; j < pages.size(); ++j) {
+			metrics_.RecordWrite(latency);
+			GetShard(writes[j].page_id_).FinishFlush(*pages[j], !error);
+			is_flushed[written[j]] = error ? 0 : 1;
+		}
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+	if (wait_for_latch) {
+		for (auto i : skipped) {
+			is_flushed[i] = FlushPage(page_ids[i], true) ? 1 : 0;
+		}
 	}
-	frame_id_t frame_id = page_table_[page_id];
-	Page &page = pages_[frame_id];
-	disk_manager_.WritePage(page_id, page.GetData());
-	page.is_dirty_ = false;
-	return true;
+	return is_flushed;
 }
 
 void BufferPool::FlushAllPages() {
-	for (frame_id_t i = 0; i < pool_size_; i++) {
-		FlushPage(pages_[i].page_id_);
+	// clean frames are skipped, there is nothing to write for them
+	FlushPages(CollectDirtyPages());
+	disk_manager_.Sync();
+}
+
+void BufferPool::SaveResidentPages(const std::filesystem::path &path) {
+	std::vector<std::vector<PageId>> shard_pages;
+	size_t num_pages = 0;
+	for (auto &shard : shards_) {
+		shard_pages.push_back(shard->CollectResidentPages());
+		num_pages += shard_pages.back().size();
+	}
+	// every shard ranks its own pages, interleaving them keeps the hottest pages of all shards up front
+	std::vector<uint64_t> page_keys;
+	page_keys.reserve(num_pages);
+	for (size_t rank = 0; page_keys.size() < num_pages; ++rank) {
+		for (const auto &pages : shard_pages) {
+			if (rank < pages.size()) {
+				page_keys.push_back(pages[rank].Pack());
+			}
+		}
 	}
+	// serialize in memory first, the file stream flushes after every value
+	MemoryStream stream;
+	BinarySerializer serializer(stream);
+	serializer.WriteProperty(100, "page_keys", page_keys);
+	auto file = FileStream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	file.WriteData(stream.GetData(), stream.GetPosition());
+	LOG_INFO("Saved {} resident pages to {}", page_keys.size(), path.string());
 }
 
-bool BufferPool::DeletePage(PageId page_id) {
-	std::lock_guard<std::mutex> lock(latch_);
-	if (page_table_.find(page_id) == page_table_.end()) {
-		return true;
+size_t BufferPool::LoadResidentPages(const std::filesystem::path &path) {
+	if (!std::filesystem::exists(path)) {
+		return 0;
 	}
-	frame_id_t frame_id = page_table_[page_id];
-	Page &page = pages_[frame_id];
-	if (page.pin_count_ > 0) {
-		return false;
+	std::vector<uint64_t> page_keys;
+	try {
+		auto file = FileStream(path, std::ios::in | std::ios::binary);
+		BinaryDeserializer deserializer(file);
+		deserializer.ReadProperty(100, "page_keys", page_keys);
+	} catch (const std::exception &e) {
+		LOG_WARN("Ignoring unreadable buffer pool dump {}: {}", path.string(), e.what());
+		return 0;
 	}
-	page_table_.erase(page_id);
-	free_list_.push_back(frame_id);
+	// colder pages would only evict the hotter ones loaded before them
+	page_keys.resize(std::min(page_keys.size(), static_cast<size_t>(GetPoolSize())));
+	// packed keys order by table and page number, i.e. by file and offset
+	std::sort(page_keys.begin(), page_keys.end());
+	page_keys.erase(std::unique(page_keys.begin(), page_keys.end()), page_keys.end());
+	size_t run_begin = 0;
+	while (run_begin < page_keys.size()) {
+		auto run_end = run_begin + 1;
+		while (run_end < page_keys.size() && run_end - run_begin < WARM_RESTART_BATCH_PAGES &&
+		       page_keys[run_end] == page_keys[run_end - 1] + 1) {
+			run_end++;
+		}
+		PrefetchPages(PageId::Unpack(page_keys[run_begin]), run_end - run_begin);
+		run_begin = run_end;
+	}
+	LOG_INFO("Reloaded {} pages from {}", page_keys.size(), path.string());
+	return page_keys.size();
+}
 
-	pages_[frame_id].ResetMemory();
-	page.page_id_.page_number_ = INVALID_PAGE_ID;
-	page.pin_count_ = 0;
-	page.is_dirty_ = false;
-	return true;
+bool BufferPool::DeletePage(PageId page_id) {
+	return GetShard(page_id).DeletePage(page_id);
 }
 
 BasicPageGuard BufferPool::FetchPageBasic(PageId page_id) {
@@ -173,12 +423,50 @@ BasicPageGuard BufferPool::FetchPageBasic(PageId page_id) {
 	return {*this, page};
 }
 
-ReadPageGuard BufferPool::FetchPageRead(PageId page_id) {
-	auto &page = FetchPage(page_id);
+ReadPageGuard BufferPool::FetchPageRead(PageId page_id, BufferAccessStrategy *strategy) {
+	auto &page = FetchPage(page_id, strategy);
 	page.RLatch();
 	return {*this, page};
 }
 
+OptimisticReadGuard BufferPool::FetchPageOptimistic(PageId page_id) {
+	if (auto guard = GetShard(page_id).TryReadResident(page_id); guard.has_value()) {
+		return *guard;
+	}
+	// a miss is read in like any other, the pin only lasts until the guard took the version
+	auto &page = FetchPage(page_id);
+	auto guard = OptimisticReadGuard(page, page_id);
+	UnpinPage(page, false);
+	return guard;
+}
+
+Page &BufferPool::FetchPageSwizzled(PageId page_id, std::atomic<Page *> &ref) {
+	// a frame only holds pages of its own shard, so a reference is only handed to the shard of page_id once it was seen
+	// holding page_id
+	auto *page = ref.load(std::memory_order_acquire);
+	if (page != nullptr && page->GetPageId() == page_id) {
+		if (auto *pinned = GetShard(page_id).TryFetchSwizzled(*page, page_id); pinned != nullptr) {
+			return *pinned;
+		}
+	}
+	page = &FetchPage(page_id);
+	ref.store(page, std::memory_order_release);
+	return *page;
+}
+
+OptimisticReadGuard BufferPool::FetchPageOptimisticSwizzled(PageId page_id, std::atomic<Page *> &ref) {
+	auto *page = ref.load(std::memory_order_acquire);
+	if (page != nullptr && page->GetPageId() == page_id) {
+		if (auto guard = GetShard(page_id).TryReadSwizzled(*page, page_id); guard.has_value()) {
+			return *guard;
+		}
+	}
+	auto &fetched = FetchPageSwizzled(page_id, ref);
+	auto guard = OptimisticReadGuard(fetched, page_id);
+	UnpinPage(fetched, false);
+	return guard;
+}
+
 WritePageGuard BufferPool::FetchPageWrite(PageId page_id) {
 	auto &page = FetchPage(page_id);
 	page.WLatch();
@@ -0,0 +1,146 @@
+#include "storage/buffer/buffer_pool_metrics.hpp"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace db {
+uint64_t LatencyHistogramSnapshot::Percentile(double percentile) const {
+	if (count_ == 0) {
+		return 0;
+	}
+	auto rank = static_cast<uint64_t>(std::ceil(percentile / 100 * static_cast<double>(count_)));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+		seen += buckets_[i];
+		if (seen >= std::max<uint64_t>(rank, 1)) {
+			return 1ULL << i;
+		}
+	}
+	return 1ULL << (NUM_BUCKETS - 1);
+}
+
+void LatencyHistogramSnapshot::Merge(const LatencyHistogramSnapshot &other) {
+	for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+		buckets_[i] += other.buckets_[i];
+	}
+	count_ += other.count_;
+	total_us_ += other.total_us_;
+}
+
+void LatencyHistogram::Record(std::chrono::nanoseconds latency) {
+	auto latency_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+	auto bucket = std::min<size_t>(std::bit_width(latency_us), LatencyHistogramSnapshot::NUM_BUCKETS - 1);
+	buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+	total_us_.fetch_add(latency_us, std::memory_order_relaxed);
+}
+
+LatencyHistogramSnapshot LatencyHistogram::Snapshot() const {
+	LatencyHistogramSnapshot snapshot;
+	for (size_t i = 0; i < LatencyHistogramSnapshot::NUM_BUCKETS; ++i) {
+		snapshot.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+		snapshot.count_ += snapshot.buckets_[i];
+	}
+	snapshot.total_us_ = total_us_.load(std::memory_order_relaxed);
+	return snapshot;
+}
+
+void BufferPoolMetricsSnapshot::Merge(const BufferPoolMetricsSnapshot &other) {
+	hits_ += other.hits_;
+	swizzled_hits_ += other.swizzled_hits_;
+	misses_ += other.misses_;
+	clean_evictions_ += other.clean_evictions_;
+	dirty_evictions_ += other.dirty_evictions_;
+	flushes_ += other.flushes_;
+	prefetched_pages_ += other.prefetched_pages_;
+	pin_waits_ += other.pin_waits_;
+	pin_wait_time_ += other.pin_wait_time_;
+	latch_waits_ += other.latch_waits_;
+	latch_wait_time_ += other.latch_wait_time_;
+	read_latency_.Merge(other.read_latency_);
+	write_latency_.Merge(other.write_latency_);
+	for (const auto &[table_oid, table] : other.tables_) {
+		auto &merged = tables_[table_oid];
+		merged.hits_ += table.hits_;
+		merged.misses_ += table.misses_;
+		merged.evictions_ += table.evictions_;
+	}
+}
+
+std::string BufferPoolMetricsSnapshot::ToString() const {
+	return fmt::format("BufferPoolMetrics {{ hits={}, swizzled_hits={}, misses={}, hit_ratio={:.3f}, "
+	                   "clean_evictions={}, dirty_evictions={}, flushes={}, prefetched_pages={}, pin_waits={} ({}us), "
+	                   "latch_waits={} ({}us), read_p50={}us, read_p99={}us, write_p50={}us, write_p99={}us }}",
+	                   hits_, swizzled_hits_, misses_, GetHitRatio(), clean_evictions_, dirty_evictions_, flushes_,
+	                   prefetched_pages_,
+	                   pin_waits_, std::chrono::duration_cast<std::chrono::microseconds>(pin_wait_time_).count(),
+	                   latch_waits_, std::chrono::duration_cast<std::chrono::microseconds>(latch_wait_time_).count(),
+	                   read_latency_.Percentile(50), read_latency_.Percentile(99), write_latency_.Percentile(50),
+	                   write_latency_.Percentile(99));
+}
+
+BufferPoolMetricsSnapshot BufferPoolMetrics::Snapshot() const {
+	BufferPoolMetricsSnapshot snapshot;
+	snapshot.hits_ = hits_.load(std::memory_order_relaxed);
+	snapshot.swizzled_hits_ = swizzled_hits_.load(std::memory_order_relaxed);
+	snapshot.misses_ = misses_.load(std::memory_order_relaxed);
+	snapshot.clean_evictions_ = clean_evictions_.load(std::memory_order_relaxed);
+	snapshot.dirty_evictions_ = dirty_evictions_.load(std::memory_order_relaxed);
+	snapshot.flushes_ = flushes_.load(std::memory_order_relaxed);
+	snapshot.prefetched_pages_ = prefetched_pages_.load(std::memory_order_relaxed);
+	snapshot.pin_waits_ = pin_waits_.load(std::memory_order_relaxed);
+	snapshot.pin_wait_time_ = std::chrono::nanoseconds(pin_wait_ns_.load(std::memory_order_relaxed));
+	snapshot.latch_waits_ = latch_waits_.load(std::memory_order_relaxed);
+	snapshot.latch_wait_time_ = std::chrono::nanoseconds(latch_wait_ns_.load(std::memory_order_relaxed));
+	snapshot.read_latency_ = read_latency_.Snapshot();
+	snapshot.write_latency_ = write_latency_.Snapshot();
+	const auto *directory = directory_.load(std::memory_order_acquire);
+	for (size_t chunk_idx = 0; chunk_idx < directory->chunks_.size(); ++chunk_idx) {
+		const auto *chunk = directory->chunks_[chunk_idx].load(std::memory_order_acquire);
+		if (chunk == nullptr) {
+			continue;
+		}
+		for (size_t i = 0; i < TABLE_CHUNK_SIZE; ++i) {
+			const auto &table = (*chunk)[i];
+			TableMetricsSnapshot table_snapshot {table.hits_.load(std::memory_order_relaxed),
+			                                     table.misses_.load(std::memory_order_relaxed),
+			                                     table.evictions_.load(std::memory_order_relaxed)};
+			if (table_snapshot.hits_ + table_snapshot.misses_ + table_snapshot.evictions_ > 0) {
+				auto table_oid = static_cast<table_oid_t>(chunk_idx * TABLE_CHUNK_SIZE + i) + SYSTEM_CATALOG_ID;
+				snapshot.tables_[table_oid] = table_snapshot;
+			}
+		}
+	}
+	return snapshot;
+}
+
+BufferPoolMetrics::BufferPoolMetrics() {
+	directories_.push_back(std::make_unique<ChunkDirectory>(4));
+	directory_.store(directories_.back().get(), std::memory_order_release);
+}
+
+BufferPoolMetrics::~BufferPoolMetrics() = default;
+
+BufferPoolMetrics::TableChunk *BufferPoolMetrics::AddChunk(size_t chunk_idx) {
+	std::lock_guard lock(table_latch_);
+	auto *directory = directory_.load(std::memory_order_relaxed);
+	if (chunk_idx >= directory->chunks_.size()) {
+		auto grown = std::make_unique<ChunkDirectory>(std::max(chunk_idx + 1, 2 * directory->chunks_.size()));
+		for (size_t i = 0; i < directory->chunks_.size(); ++i) {
+			grown->chunks_[i].store(directory->chunks_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+		directories_.push_back(std::move(grown));
+		directory = directories_.back().get();
+		directory_.store(directory, std::memory_order_release);
+	}
+	auto *chunk = directory->chunks_[chunk_idx].load(std::memory_order_relaxed);
+	if (chunk == nullptr) {
+		chunks_.push_back(std::make_unique<TableChunk>());
+		chunk = chunks_.back().get();
+		directory->chunks_[chunk_idx].store(chunk, std::memory_order_release);
+	}
+	return chunk;
+}
+} // namespace db
@@ -0,0 +1,86 @@
+#include "storage/buffer/buffer_pool_set.hpp"
+
+#include "common/exception.hpp"
+#include "common/logger.hpp"
+#include "storage/file_path_manager.hpp"
+
+namespace db {
+BufferPoolSet::BufferPoolSet(DiskManager &disk_manager, const BufferPoolConfig &default_pool_config)
+    : disk_manager_(disk_manager) {
+	auto config = default_pool_config;
+	config.name_ = DEFAULT_BUFFER_POOL;
+	default_pool_ = &AddPool(config);
+}
+
+BufferPool &BufferPoolSet::AddPool(const BufferPoolConfig &config) {
+	if (pools_.contains(config.name_)) {
+		throw RuntimeException(fmt::format("Buffer pool {} already exists", config.name_));
+	}
+	auto pool = std::make_unique<BufferPool>(config.pool_size_, disk_manager_, config.replacer_type_, 0,
+	                                         config.max_pool_size_, config.use_huge_pages_);
+	LOG_INFO("Created buffer pool {} with {} frames", config.name_, config.pool_size_);
+	return *pools_.emplace(config.name_, std::move(pool)).first->second;
+}
+
+BufferPool &BufferPoolSet::GetPool(const std::string &name) {
+	auto it = pools_.find(name);
+	return it != pools_.end() ? *it->second : *default_pool_;
+}
+
+BufferPool &BufferPoolSet::GetExistingPool(const std::string &name) {
+	auto it = pools_.find(name);
+	if (it == pools_.end()) {
+		throw RuntimeException(fmt::format("Buffer pool {} does not exist", name));
+	}
+	return *it->second;
+}
+
+std::vector<std::string> BufferPoolSet::GetPoolNames() const {
+	std::vector<std::string> names;
+	names.reserve(pools_.size());
+	for (const auto &[name, pool] : pools_) {
+		names.push_back(name);
+	}
+	return names;
+}
+
+void BufferPoolSet::StartBackgroundWriters(BackgroundWriterConfig config) {
+	for (auto &[name, pool] : pools_) {
+		pool->StartBackgroundWriter(config);
+	}
+}
+
+void BufferPoolSet::StopBackgroundWriters() {
+	for (auto &[name, pool] : pools_) {
+		pool->StopBackgroundWriter();
+	}
+}
+
+void BufferPoolSet::FlushAllPages() {
+	for (auto &[name, pool] : pools_) {
+		pool->FlushAllPages();
+	}
+}
+
+void BufferPoolSet::SaveResidentPages() {
+	for (auto &[name, pool] : pools_) {
+		pool->SaveResidentPages(FilePathManager::GetInstance().GetBufferPoolDumpPath(name));
+	}
+}
+
+size_t BufferPoolSet::LoadResidentPages() {
+	size_t num_pages = 0;
+	for (auto &[name, pool] : pools_) {
+		num_pages += pool->LoadResidentPages(FilePathManager::GetInstance().GetBufferPoolDumpPath(name));
+	}
+	return num_pages;
+}
+
+std::map<std::string, BufferPoolMetricsSnapshot> BufferPoolSet::GetMetrics() const {
+	std::map<std::string, BufferPoolMetricsSnapshot> metrics;
+	for (const auto &[name, pool] : pools_) {
+		metrics.emplace(name, pool->GetMetrics());
+	}
+	return metrics;
+}
+} // namespace db
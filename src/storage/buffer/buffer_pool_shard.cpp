@@ -0,0 +1,701 @@
+#include "storage/buffer/buffer_pool_shard.hpp"
+
+#include "common/config.hpp"
+#include "common/exception.hpp"
+#include "common/logger.hpp"
+#include "storage/buffer/clock_replacer.hpp"
+#include "storage/buffer/lru_k_replacer.hpp"
+#include "storage/buffer/random_replacer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace db {
+BufferPoolShard::BufferPoolShard(frame_id_t pool_size, frame_id_t max_pool_size, FrameArena &arena,
+                                 size_t first_arena_frame, DiskManager &disk_manager, ReplacerType replacer_type)
+    : max_pool_size_(max_pool_size), pool_size_(pool_size), replacer_(MakeReplacer(replacer_type, max_pool_size)),
+      disk_manager_(disk_manager), page_table_(max_pool_size),
+      descriptors_(std::make_unique<FrameDescriptor[]>(max_pool_size)),
+      pages_(std::make_unique<Page[]>(max_pool_size)), arena_(arena), first_arena_frame_(first_arena_frame) {
+	assert(pool_size > 0 && pool_size <= max_pool_size && "pool size out of range");
+	assert(first_arena_frame + max_pool_size <= arena.GetNumFrames() && "the shard does not fit into the arena");
+	for (frame_id_t i = 0; i < max_pool_size_; ++i) {
+		descriptors_[i].pin_count_ = FrameDescriptor::FRAME_LOCKED;
+		pages_[i].descriptor_ = &descriptors_[i];
+		pages_[i].data_ = arena_.GetFrame(first_arena_frame_ + i);
+	}
+	for (frame_id_t i = 0; i < pool_size; ++i) {
+		AddFrame(i);
+	}
+}
+
+void BufferPoolShard::AddFrame(frame_id_t frame_id) {
+	auto &desc = descriptors_[frame_id];
+	if (desc.pin_count_ != FrameDescriptor::FRAME_LOCKED) {
+		// a shrink that failed to write back a page left the frame in use, a free one has to be handed out again
+		if (desc.page_id_.load().page_number_ == INVALID_PAGE_ID &&
+		    std::find(free_list_.begin(), free_list_.end(), frame_id) == free_list_.end()) {
+			free_list_.push_back(frame_id);
+		}
+		return;
+	}
+	GetPage(frame_id).ResetMemory();
+	desc.page_id_ = PageId {};
+	desc.is_referenced_ = false;
+	desc.pin_count_.store(0, std::memory_order_release);
+	free_list_.push_back(frame_id);
+}
+
+bool BufferPoolShard::TryRetireFrame(frame_id_t frame_id, std::vector<PageId> &dirty_pages) {
+	auto &desc = descriptors_[frame_id];
+	// apart from retired frames, frames are only locked while the latch is held
+	if (desc.pin_count_ == FrameDescriptor::FRAME_LOCKED) {
+		return true;
+	}
+	auto page_id = desc.page_id_.load();
+	if (desc.is_dirty_) {
+		dirty_pages.push_back(page_id);
+		return false;
+	}
+	if (desc.io_in_progress_ || !desc.TryLock()) {
+		return false;
+	}
+	if (page_id.page_number_ != INVALID_PAGE_ID) {
+		auto &page = GetPage(frame_id);
+		page.BeginReplace();
+		page_table_.Erase(page_id);
+		desc.page_id_ = PageId {};
+		page.EndReplace();
+	}
+	replacer_->Remove(frame_id);
+	return true;
+}
+
+frame_id_t BufferPoolShard::Resize(frame_id_t pool_size, std::chrono::steady_clock::time_point deadline) {
+	assert(pool_size > 0 && pool_size <= max_pool_size_ && "pool size out of range");
+	auto lock = LockLatch();
+	auto old_pool_size = pool_size_.load();
+	pool_size_ = pool_size;
+	for (auto frame_id = old_pool_size; frame_id < pool_size; ++frame_id) {
+		AddFrame(frame_id);
+	}
+	if (pool_size >= old_pool_size) {
+		return pool_size;
+	}
+	auto is_retiring = [&](frame_id_t frame_id) { return frame_id >= pool_size; };
+	free_list_.remove_if(is_retiring);
+	// queries keep running on the remaining frames while the dropped ones are drained
+	while (true) {
+		std::vector<PageId> dirty_pages;
+		bool drained = true;
+		for (auto frame_id = pool_size; frame_id < old_pool_size; ++frame_id) {
+			drained = TryRetireFrame(frame_id, dirty_pages) && drained;
+		}
+		if (drained) {
+			break;
+		}
+		if (std::chrono::steady_clock::now() >= deadline) {
+			// retired frames are locked, the ones after the last frame still in use are dropped and the others kept
+			auto new_pool_size = old_pool_size;
+			while (new_pool_size > pool_size &&
+			       descriptors_[new_pool_size - 1].pin_count_ == FrameDescriptor::FRAME_LOCKED) {
+				new_pool_size--;
+			}
+			pool_size_ = new_pool_size;
+			for (auto frame_id = pool_size; frame_id < new_pool_size; ++frame_id) {
+				AddFrame(frame_id);
+			}
+			pool_size = new_pool_size;
+			break;
+		}
+		lock.unlock();
+		for (const auto &page_id : dirty_pages) {
+			FlushPage(page_id);
+		}
+		if (dirty_pages.empty()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		lock.lock();
+	}
+	// a frame that was aborted or deleted during the drain may have been put back
+	free_list_.remove_if(is_retiring);
+	// lock-free pins never touch the data of a locked frame. optimistic readers may still look at it, the memory stays
+	// mapped and their page id check fails, so it can go
+	if (pool_size < old_pool_size) {
+		arena_.Release(first_arena_frame_ + pool_size, old_pool_size - pool_size);
+	}
+	return pool_size;
+}
+
+std::unique_lock<std::mutex> BufferPoolShard::LockLatch() {
+	std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		auto start = std::chrono::steady_clock::now();
+		lock.lock();
+		metrics_.RecordLatchWait(std::chrono::steady_clock::now() - start);
+	}
+	return lock;
+}
+
+std::unique_ptr<Replacer> BufferPoolShard::MakeReplacer(ReplacerType replacer_type, frame_id_t pool_size) {
+	switch (replacer_type) {
+	case ReplacerType::RANDOM:
+		return std::make_unique<RandomBogoReplacer>();
+	case ReplacerType::LRU_K:
+		return std::make_unique<LRUKReplacer>(pool_size, LRU_K_REPLACER_K);
+	case ReplacerType::CLOCK:
+		return std::make_unique<ClockReplacer>(pool_size);
+	}
+	throw NotImplementedException("Unsupported replacer type");
+}
+
+bool BufferPoolShard::AllocateFrame(frame_id_t &frame_id, BufferRing *ring) {
+	if (ring != nullptr) {
+		const auto *slot = ring->GetReusableSlot();
+		if (slot != nullptr && slot->frame_id_ < pool_size_.load(std::memory_order_relaxed)) {
+			auto &desc = descriptors_[slot->frame_id_];
+			if (desc.page_id_.load() == slot->page_id_ && !desc.io_in_progress_ && desc.TryLock()) {
+				replacer_->Remove(slot->frame_id_);
+				frame_id = slot->frame_id_;
+				return true;
+			}
+		}
+	}
+	// every frame is handed out locked, so a pin taken through a stale page table entry cannot slip in
+	for (auto num_free = free_list_.size(); num_free > 0; --num_free) {
+		frame_id = free_list_.front();
+		free_list_.pop_front();
+		// a shrink is draining the frame
+		if (frame_id >= pool_size_.load(std::memory_order_relaxed)) {
+			continue;
+		}
+		if (descriptors_[frame_id].TryLock()) {
+			return true;
+		}
+		// pinned by a lookup that found a stale page table entry and is about to let go
+		free_list_.push_back(frame_id);
+	}
+	// gotta evict a random frame because
+	while (replacer_->Evict(frame_id)) {
+		// a frame can be pinned without the latch after it became evictable, its last unpin hands it back with its
+		// history, which only starts over once the frame is taken
+		if (descriptors_[frame_id].TryLock()) {
+			assert(descriptors_[frame_id].page_id_.load().page_number_ >= 0);
+			replacer_->Remove(frame_id);
+			return true;
+		}
+	}
+	replacer_->Print();
+	return false;
+}
+
+Page &BufferPoolShard::ClaimFrame(PageId page_id, std::optional<PageId> &dirty_victim, BufferRing *ring) {
+	frame_id_t frame_id = -1;
+	if (!AllocateFrame(frame_id, ring)) {
+		throw std::runtime_error("Failed to allocate frame");
+	}
+	return ClaimFrame(page_id, frame_id, dirty_victim, ring);
+}
+
+Page &BufferPoolShard::ClaimFrame(PageId page_id, frame_id_t frame_id, std::optional<PageId> &dirty_victim,
+                                  BufferRing *ring) {
+	// assert that frame id is not in the free list
+	assert(std::find(free_list_.begin(), free_list_.end(), frame_id) == free_list_.end() &&
+	       "frame id should not be in the free list");
+	// assert that frame id is valid
+	assert(frame_id != -1 && "frame id has to be assigned a valid value here");
+
+	auto &desc = descriptors_[frame_id];
+	assert(desc.pin_count_ == FrameDescriptor::FRAME_LOCKED && "the frame has to be locked by AllocateFrame");
+	auto old_page_id = desc.page_id_.load();
+	// get rid fo the stale page table record, a dirty victim stays visible as being written until its write-back is
+	// done
+	page_table_.Erase(old_page_id);
+	if (old_page_id.page_number_ != INVALID_PAGE_ID) {
+		metrics_.RecordEviction(old_page_id, desc.is_dirty_);
+	}
+	dirty_victim = std::nullopt;
+	if (desc.is_dirty_) {
+		dirty_victim = old_page_id;
+		pages_being_written_.insert(old_page_id);
+		SetDirty(desc, false);
+	}
+
+	assert(!page_table_.Contains(page_id) && "page should not be in the page table before it gets a frame");
+	replacer_->Pin(frame_id);
+	// optimistic readers of the frame fail until FinishIo, the frame gets another page and new content
+	GetPage(frame_id).BeginReplace();
+	desc.io_in_progress_ = true;
+	desc.is_referenced_ = false;
+	// references to the children of the previous page, the references to the previous page held by its parent fail
+	// their page id check from here on
+	GetPage(frame_id).ResetChildRefs();
+	desc.page_id_ = page_id;
+	// unlocking the frame with our pin, lock-free lookups can find the frame from here on and wait for the io
+	desc.pin_count_.store(1, std::memory_order_release);
+	page_table_.Insert(page_id, frame_id);
+	if (ring != nullptr) {
+		ring->Record(frame_id, page_id);
+	}
+	return GetPage(frame_id);
+}
+
+void BufferPoolShard::SetDirty(FrameDescriptor &desc, bool is_dirty) {
+	if (desc.is_dirty_ == is_dirty) {
+		return;
+	}
+	desc.is_dirty_ = is_dirty;
+	if (is_dirty) {
+		// stale entries of frames that were cleaned in between are dropped by CollectDirtyPages
+		dirty_frames_.push_back(GetFrameId(desc));
+		num_dirty_.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		num_dirty_.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+void BufferPoolShard::PinFrame(FrameDescriptor &desc, bool record_access) {
+	// frames are only locked while the latch is held, so this cannot observe FRAME_LOCKED
+	auto frame_id = GetFrameId(desc);
+	auto was_unpinned = desc.pin_count_.fetch_add(1) == 0;
+	if (record_access) {
+		replacer_->Pin(frame_id);
+	} else if (was_unpinned) {
+		replacer_->PinWithoutAccess(frame_id);
+	}
+}
+
+void BufferPoolShard::UnpinFrame(FrameDescriptor &desc) {
+	assert(desc.pin_count_ > 0);
+	// other pins are added and dropped without the latch, only the one that brings the count to zero tells the replacer
+	if (desc.pin_count_.fetch_sub(1) != 1) {
+		return;
+	}
+	// a free frame may have been pinned through a stale page table entry, it must not become evictable
+	if (desc.page_id_.load().page_number_ == INVALID_PAGE_ID) {
+		return;
+	}
+	auto frame_id = GetFrameId(desc);
+	if (desc.is_referenced_.exchange(false)) {
+		replacer_->Pin(frame_id);
+	}
+	replacer_->Unpin(frame_id);
+}
+
+void BufferPoolShard::WriteBackVictim(std::unique_lock<std::mutex> &lock, Page &page, PageId victim_page_id) {
+	// the frame still holds the victim's data and is pinned by the caller, so it is safe to write without the latch
+	lock.unlock();
+	std::exception_ptr error;
+	auto start = std::chrono::steady_clock::now();
+	try {
+		disk_manager_.WritePage(victim_page_id, page.GetData());
+	} catch (...) {
+		LOG_ERROR("Failed to write back evicted page {}", victim_page_id.ToString());
+		error = std::current_exception();
+	}
+	metrics_.RecordWrite(std::chrono::steady_clock::now() - start);
+	lock.lock();
+	pages_being_written_.erase(victim_page_id);
+	io_cv_.notify_all();
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+void BufferPoolShard::FinishIo(FrameDescriptor &desc) {
+	GetPage(GetFrameId(desc)).EndReplace();
+	desc.io_in_progress_ = false;
+	io_cv_.notify_all();
+}
+
+void BufferPoolShard::AbortIo(FrameDescriptor &desc) {
+	// threads waiting on the frame see the page id mismatch, drop their pins and retry
+	page_table_.Erase(desc.page_id_);
+	desc.page_id_ = PageId {};
+	SetDirty(desc, false);
+	// the frame goes back to the free list right away, AllocateFrame skips it until the last waiter let go
+	auto frame_id = GetFrameId(desc);
+	replacer_->Remove(frame_id);
+	free_list_.push_back(frame_id);
+	FinishIo(desc);
+	UnpinFrame(desc);
+}
+
+bool BufferPoolShard::WaitForResident(std::unique_lock<std::mutex> &lock, FrameDescriptor &desc, PageId page_id) {
+	auto start = std::chrono::steady_clock::now();
+	io_cv_.wait(lock, [&] { return !desc.io_in_progress_; });
+	metrics_.RecordPinWait(std::chrono::steady_clock::now() - start);
+	if (desc.page_id_.load() == page_id) {
+		return true;
+	}
+	// the load failed, our pin on the frame has to be dropped
+	UnpinFrame(desc);
+	return false;
+}
+
+Page &BufferPoolShard::NewPage(PageId page_id) {
+	auto lock = LockLatch();
+	std::optional<PageId> dirty_victim;
+	Page &page = ClaimFrame(page_id, dirty_victim, nullptr);
+	auto &desc = *page.descriptor_;
+	if (dirty_victim.has_value()) {
+		try {
+			WriteBackVictim(lock, page, *dirty_victim);
+		} catch (...) {
+			AbortIo(desc);
+			throw;
+		}
+	}
+	// reset the memory for the new page, it does not exist on disk yet so it has to be written back on eviction
+	page.ResetMemory();
+	SetDirty(desc, true);
+	FinishIo(desc);
+	return page;
+}
+
+Page *BufferPoolShard::TryFetchResident(PageId page_id) {
+	auto frame_id = page_table_.Find(page_id);
+	if (frame_id == INVALID_FRAME_ID) {
+		return nullptr;
+	}
+	auto &page = GetPage(frame_id);
+	if (!TryPinResident(page, page_id)) {
+		return nullptr;
+	}
+	metrics_.RecordHit(page_id);
+	return &page;
+}
+
+bool BufferPoolShard::TryPinResident(Page &page, PageId page_id) {
+	auto &desc = *page.descriptor_;
+	if (!desc.TryPin()) {
+		return false;
+	}
+	// the lookup raced with the frame being taken over or filled, the latched path sorts it out
+	if (desc.page_id_.load(std::memory_order_acquire) != page_id ||
+	    desc.io_in_progress_.load(std::memory_order_acquire)) {
+		UnpinPage(page, false);
+		return false;
+	}
+	return true;
+}
+
+Page *BufferPoolShard::TryFetchSwizzled(Page &page, PageId page_id) {
+	if (!TryPinResident(page, page_id)) {
+		return nullptr;
+	}
+	metrics_.RecordSwizzledHit(page_id);
+	return &page;
+}
+
+std::optional<OptimisticReadGuard> BufferPoolShard::TryReadResident(PageId page_id) {
+	auto frame_id = page_table_.Find(page_id);
+	if (frame_id == INVALID_FRAME_ID) {
+		return std::nullopt;
+	}
+	// a frame that is being filled has an odd version, so this also skips pages in flight
+	auto guard = OptimisticReadGuard(GetPage(frame_id), page_id);
+	if (!guard.Validate()) {
+		return std::nullopt;
+	}
+	metrics_.RecordHit(page_id);
+	return guard;
+}
+
+std::optional<OptimisticReadGuard> BufferPoolShard::TryReadSwizzled(Page &page, PageId page_id) {
+	auto guard = OptimisticReadGuard(page, page_id);
+	if (!guard.Validate()) {
+		return std::nullopt;
+	}
+	metrics_.RecordSwizzledHit(page_id);
+	return guard;
+}
+
+Page &BufferPoolShard::FetchPage(PageId page_id, BufferRing *ring) {
+	assert(page_id.page_number_ != INVALID_PAGE_ID && "page number should be valid");
+	if (auto *page = TryFetchResident(page_id); page != nullptr) {
+		return *page;
+	}
+	auto lock = LockLatch();
+	while (true) {
+		auto frame_id = page_table_.Find(page_id);
+		if (frame_id != INVALID_FRAME_ID) {
+			auto &desc = descriptors_[frame_id];
+			PinFrame(desc, true);
+			// another thread is reading the page in, wait for it instead of issuing a second read. if that read fails
+			// the fetch retries and is counted once, as the miss it then turns into
+			if (!desc.io_in_progress_ || WaitForResident(lock, desc, page_id)) {
+				metrics_.RecordHit(page_id);
+				return GetPage(frame_id);
+			}
+			continue;
+		}
+		// the page was just evicted and its latest version is still on the way to disk
+		if (pages_being_written_.contains(page_id)) {
+			auto start = std::chrono::steady_clock::now();
+			io_cv_.wait(lock);
+			metrics_.RecordPinWait(std::chrono::steady_clock::now() - start);
+			continue;
+		}
+		break;
+	}
+	metrics_.RecordMiss(page_id);
+
+	std::optional<PageId> dirty_victim;
+	Page &page = ClaimFrame(page_id, dirty_victim, ring);
+	auto &desc = *page.descriptor_;
+	try {
+		if (dirty_victim.has_value()) {
+			WriteBackVictim(lock, page, *dirty_victim);
+		}
+		lock.unlock();
+		auto start = std::chrono::steady_clock::now();
+		disk_manager_.ReadPage(page_id, page.GetData());
+		metrics_.RecordRead(std::chrono::steady_clock::now() - start);
+		lock.lock();
+	} catch (...) {
+		if (!lock.owns_lock()) {
+			lock.lock();
+		}
+		AbortIo(desc);
+		throw;
+	}
+	FinishIo(desc);
+	return page;
+}
+
+Page *BufferPoolShard::ClaimForPrefetch(PageId page_id, BufferRing *ring) {
+	assert(page_id.page_number_ != INVALID_PAGE_ID && "page number should be valid");
+	auto lock = LockLatch();
+	if (page_table_.Contains(page_id) || pages_being_written_.contains(page_id)) {
+		return nullptr;
+	}
+	// read-ahead is best effort, never fail because every frame is pinned
+	frame_id_t frame_id = -1;
+	if (!AllocateFrame(frame_id, ring)) {
+		return nullptr;
+	}
+	std::optional<PageId> dirty_victim;
+	Page &page = ClaimFrame(page_id, frame_id, dirty_victim, ring);
+	if (dirty_victim.has_value()) {
+		try {
+			WriteBackVictim(lock, page, *dirty_victim);
+		} catch (...) {
+			AbortIo(*page.descriptor_);
+			return nullptr;
+		}
+	}
+	return &page;
+}
+
+void BufferPoolShard::FinishPrefetch(Page &page, bool success, bool keep_pin) {
+	auto lock = LockLatch();
+	auto &desc = *page.descriptor_;
+	if (!success) {
+		AbortIo(desc);
+		return;
+	}
+	FinishIo(desc);
+	if (!keep_pin) {
+		UnpinFrame(desc);
+	}
+}
+
+void BufferPoolShard::PinOrClaim(std::span<const PageId> page_ids, std::span<Page *> pages,
+                                 std::span<uint8_t> is_claimed, BufferRing *ring) {
+	assert(page_ids.size() == pages.size() && page_ids.size() == is_claimed.size());
+	auto lock = LockLatch();
+	for (size_t i = 0; i < page_ids.size(); ++i) {
+		auto page_id = page_ids[i];
+		assert(page_id.page_number_ != INVALID_PAGE_ID && "page number should be valid");
+		pages[i] = nullptr;
+		is_claimed[i] = 0;
+		auto frame_id = page_table_.Find(page_id);
+		if (frame_id != INVALID_FRAME_ID) {
+			auto &desc = descriptors_[frame_id];
+			// waiting for another thread's read would hold up the rest of the batch
+			if (!desc.io_in_progress_) {
+				PinFrame(desc, true);
+				metrics_.RecordHit(page_id);
+				pages[i] = &GetPage(frame_id);
+			}
+			continue;
+		}
+		frame_id_t victim_frame_id = INVALID_FRAME_ID;
+		if (pages_being_written_.contains(page_id) || !AllocateFrame(victim_frame_id, ring)) {
+			continue;
+		}
+		metrics_.RecordMiss(page_id);
+		std::optional<PageId> dirty_victim;
+		Page &page = ClaimFrame(page_id, victim_frame_id, dirty_victim, ring);
+		if (dirty_victim.has_value()) {
+			try {
+				WriteBackVictim(lock, page, *dirty_victim);
+			} catch (...) {
+				AbortIo(*page.descriptor_);
+				continue;
+			}
+		}
+		pages[i] = &page;
+		is_claimed[i] = 1;
+	}
+}
+
+bool BufferPoolShard::UnpinPage(PageId page_id, bool is_dirty) {
+	assert(page_id.page_number_ != INVALID_PAGE_ID);
+	auto lock = LockLatch();
+	auto frame_id = page_table_.Find(page_id);
+	if (frame_id == INVALID_FRAME_ID) {
+		LOG_ERROR("Page %s not found in page table", page_id.ToString().c_str());
+		assert(false);
+		return false;
+	}
+	return UnpinLatched(descriptors_[frame_id], is_dirty);
+}
+
+bool BufferPoolShard::UnpinPage(Page &page, bool is_dirty) {
+	auto &desc = *page.descriptor_;
+	// a page that is already dirty and still pinned by others is unpinned without the latch
+	if ((!is_dirty || desc.is_dirty_.load(std::memory_order_relaxed)) && desc.TryUnpinShared()) {
+		return true;
+	}
+	auto lock = LockLatch();
+	return UnpinLatched(desc, is_dirty);
+}
+
+bool BufferPoolShard::UnpinLatched(FrameDescriptor &desc, bool is_dirty) {
+	if (is_dirty) {
+		SetDirty(desc, true);
+	}
+	if (desc.pin_count_ == 0) {
+		return false;
+	}
+	UnpinFrame(desc);
+	return true;
+}
+
+bool BufferPoolShard::FlushPage(PageId page_id, bool wait_for_latch) {
+	auto *page = BeginFlush(page_id, wait_for_latch);
+	if (page == nullptr) {
+		return false;
+	}
+	auto start = std::chrono::steady_clock::now();
+	try {
+		disk_manager_.WritePage(page_id, page->GetData());
+	} catch (...) {
+		metrics_.RecordWrite(std::chrono::steady_clock::now() - start);
+		FinishFlush(*page, false);
+		throw;
+	}
+	metrics_.RecordWrite(std::chrono::steady_clock::now() - start);
+	FinishFlush(*page, true);
+	return true;
+}
+
+Page *BufferPoolShard::BeginFlush(PageId page_id, bool wait_for_latch) {
+	auto lock = LockLatch();
+	auto frame_id = page_table_.Find(page_id);
+	if (frame_id == INVALID_FRAME_ID) {
+		return nullptr;
+	}
+	auto &desc = descriptors_[frame_id];
+	Page &page = GetPage(frame_id);
+	// pin the frame so it cannot be evicted while it is written without the latch
+	PinFrame(desc, false);
+	if (desc.io_in_progress_ && !WaitForResident(lock, desc, page_id)) {
+		return nullptr;
+	}
+	lock.unlock();
+	// the read latch keeps writers out so the page image on disk is consistent
+	if (wait_for_latch) {
+		page.RLatch();
+	} else if (!page.TryRLatch()) {
+		lock.lock();
+		UnpinFrame(desc);
+		return nullptr;
+	}
+	lock.lock();
+	// clear the dirty flag before writing so a concurrent modification marks the page dirty again
+	SetDirty(desc, false);
+	return &page;
+}
+
+void BufferPoolShard::FinishFlush(Page &page, bool success) {
+	page.RUnlatch();
+	auto lock = LockLatch();
+	auto &desc = *page.descriptor_;
+	if (!success) {
+		SetDirty(desc, true);
+	}
+	UnpinFrame(desc);
+	if (success) {
+		metrics_.RecordFlush();
+	}
+}
+
+std::vector<PageId> BufferPoolShard::CollectDirtyPages() {
+	auto lock = LockLatch();
+	std::sort(dirty_frames_.begin(), dirty_frames_.end());
+	dirty_frames_.erase(std::unique(dirty_frames_.begin(), dirty_frames_.end()), dirty_frames_.end());
+	std::erase_if(dirty_frames_, [&](frame_id_t frame_id) { return !descriptors_[frame_id].is_dirty_; });
+	std::vector<PageId> dirty_pages;
+	dirty_pages.reserve(dirty_frames_.size());
+	for (auto frame_id : dirty_frames_) {
+		dirty_pages.push_back(descriptors_[frame_id].page_id_.load());
+	}
+	return dirty_pages;
+}
+
+std::vector<PageId> BufferPoolShard::CollectResidentPages() {
+	auto lock = LockLatch();
+	std::vector<frame_id_t> frames;
+	for (frame_id_t frame_id = 0; frame_id < pool_size_; ++frame_id) {
+		const auto &desc = descriptors_[frame_id];
+		if (desc.page_id_.load().page_number_ != INVALID_PAGE_ID && !desc.io_in_progress_) {
+			frames.push_back(frame_id);
+		}
+	}
+	replacer_->SortByHotness(frames);
+	std::vector<PageId> resident_pages;
+	resident_pages.reserve(frames.size());
+	for (auto frame_id : frames) {
+		resident_pages.push_back(descriptors_[frame_id].page_id_.load());
+	}
+	return resident_pages;
+}
+
+bool BufferPoolShard::IsResident(PageId page_id) {
+	auto lock = LockLatch();
+	return page_table_.Contains(page_id);
+}
+
+bool BufferPoolShard::DeletePage(PageId page_id) {
+	auto lock = LockLatch();
+	auto frame_id = page_table_.Find(page_id);
+	if (frame_id == INVALID_FRAME_ID) {
+		return true;
+	}
+	auto &desc = descriptors_[frame_id];
+	if (!desc.TryLock()) {
+		return false;
+	}
+	page_table_.Erase(page_id);
+	replacer_->Remove(frame_id);
+
+	auto &page = GetPage(frame_id);
+	page.BeginReplace();
+	page.ResetMemory();
+	desc.page_id_ = PageId {};
+	page.EndReplace();
+	SetDirty(desc, false);
+	desc.pin_count_.store(0, std::memory_order_release);
+	free_list_.push_back(frame_id);
+	return true;
+}
+} // namespace db
@@ -0,0 +1,73 @@
+#include "storage/buffer/clock_replacer.hpp"
+
+#include "common/logger.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace db {
+ClockReplacer::ClockReplacer(frame_id_t num_frames) : frames_(num_frames) {
+}
+
+auto ClockReplacer::Evict(frame_id_t &frame_id) -> bool {
+	const auto num_frames = frames_.size();
+	// the first turn clears reference bits, the second one is guaranteed to find a victim if any frame is evictable
+	for (size_t i = 0; i < 2 * num_frames; ++i) {
+		auto &frame = frames_[hand_];
+		auto current = hand_;
+		hand_ = (hand_ + 1) % num_frames;
+		if (!frame.is_evictable_.load(std::memory_order_relaxed)) {
+			continue;
+		}
+		if (frame.is_referenced_.exchange(false, std::memory_order_relaxed)) {
+			continue;
+		}
+		// a Pin between the checks above and here wins, the frame is skipped rather than evicted while pinned
+		auto is_evictable = true;
+		if (!frame.is_evictable_.compare_exchange_strong(is_evictable, false, std::memory_order_relaxed)) {
+			continue;
+		}
+		frame_id = static_cast<frame_id_t>(current);
+		return true;
+	}
+	return false;
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+	assert(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size());
+	auto &frame = frames_[frame_id];
+	frame.is_referenced_.store(true, std::memory_order_relaxed);
+	frame.is_evictable_.store(false, std::memory_order_relaxed);
+}
+
+void ClockReplacer::PinWithoutAccess(frame_id_t frame_id) {
+	assert(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size());
+	frames_[frame_id].is_evictable_.store(false, std::memory_order_relaxed);
+}
+
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+	assert(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size());
+	frames_[frame_id].is_evictable_.store(true, std::memory_order_relaxed);
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+	assert(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size());
+	auto &frame = frames_[frame_id];
+	frame.is_evictable_.store(false, std::memory_order_relaxed);
+	frame.is_referenced_.store(false, std::memory_order_relaxed);
+}
+
+void ClockReplacer::SortByHotness(std::vector<frame_id_t> &frames) const {
+	// frames referenced since the last sweep are the ones the hand would pass over
+	std::stable_partition(frames.begin(), frames.end(), [&](frame_id_t frame_id) {
+		return frames_[frame_id].is_referenced_.load(std::memory_order_relaxed);
+	});
+}
+
+void ClockReplacer::Print() {
+	for (size_t i = 0; i < frames_.size(); ++i) {
+		LOG_TRACE("frame_id: {} is_evictable: {} is_referenced: {}", i, frames_[i].is_evictable_.load(),
+		          frames_[i].is_referenced_.load());
+	}
+}
+} // namespace db
@@ -0,0 +1,50 @@
+#include "storage/buffer/frame_arena.hpp"
+
+#include "common/exception.hpp"
+#include "common/logger.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sys/mman.h>
+
+namespace db {
+FrameArena::FrameArena(size_t num_frames, bool use_huge_pages) : num_frames_(num_frames) {
+	auto size = num_frames * PAGE_SIZE;
+	// over-reserve so the frames can start on a huge page boundary
+	mapping_size_ = use_huge_pages ? size + HUGE_PAGE_SIZE : size;
+	mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (mapping_ == MAP_FAILED) {
+		throw RuntimeException(fmt::format("Failed to map {} bytes for the buffer pool: {}", mapping_size_,
+		                                   std::strerror(errno)));
+	}
+	frames_ = static_cast<char *>(mapping_);
+	if (!use_huge_pages) {
+		return;
+	}
+	auto address = reinterpret_cast<uintptr_t>(mapping_);
+	frames_ += (HUGE_PAGE_SIZE - address % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+#ifdef MADV_HUGEPAGE
+	uses_huge_pages_ = madvise(frames_, size, MADV_HUGEPAGE) == 0;
+#endif
+	if (!uses_huge_pages_) {
+		LOG_WARN("Transparent huge pages are not available, the buffer pool uses regular pages");
+	}
+}
+
+FrameArena::~FrameArena() {
+	munmap(mapping_, mapping_size_);
+}
+
+void FrameArena::Release(size_t first_frame_idx, size_t num_frames) {
+	assert(first_frame_idx + num_frames <= num_frames_);
+	if (num_frames == 0) {
+		return;
+	}
+	// a huge page that is only partially released is split by the kernel
+	if (madvise(GetFrame(first_frame_idx), num_frames * PAGE_SIZE, MADV_DONTNEED) != 0) {
+		LOG_WARN("Failed to release {} buffer frames: {}", num_frames, std::strerror(errno));
+	}
+}
+} // namespace db
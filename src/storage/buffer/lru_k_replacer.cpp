@@ -0,0 +1,98 @@
+#include "storage/buffer/lru_k_replacer.hpp"
+
+#include "common/logger.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace db {
+LRUKReplacer::LRUKReplacer(frame_id_t num_frames, uint32_t k) : k_(k), frames_(num_frames) {
+	assert(k_ > 0 && "k has to be positive");
+	for (auto &frame : frames_) {
+		frame.history_.resize(k_);
+	}
+}
+
+auto LRUKReplacer::GetEvictionKey(const FrameHistory &frame) const -> EvictionKey {
+	assert(frame.size_ > 0);
+	// when the ring is full, next_ points at the oldest (k-th most recent) access
+	if (frame.size_ == k_) {
+		return {true, frame.history_[frame.next_]};
+	}
+	return {false, frame.history_[0]};
+}
+
+void LRUKReplacer::RecordAccess(FrameHistory &frame) {
+	frame.history_[frame.next_] = current_timestamp_++;
+	frame.next_ = (frame.next_ + 1) % k_;
+	if (frame.size_ < k_) {
+		frame.size_++;
+	}
+}
+
+auto LRUKReplacer::Evict(frame_id_t &frame_id) -> bool {
+	if (evictable_frames_.empty()) {
+		return false;
+	}
+	auto victim = evictable_frames_.begin();
+	frame_id = victim->second;
+	evictable_frames_.erase(victim);
+	// the history is kept until the frame is removed, a victim that turns out to be pinned comes back through Unpin
+	// with its accesses intact
+	frames_[frame_id].is_evictable_ = false;
+	return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+	PinWithoutAccess(frame_id);
+	RecordAccess(frames_[frame_id]);
+}
+
+void LRUKReplacer::PinWithoutAccess(frame_id_t frame_id) {
+	assert(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size());
+	auto &frame = frames_[frame_id];
+	if (frame.is_evictable_) {
+		evictable_frames_.erase({GetEvictionKey(frame), frame_id});
+		frame.is_evictable_ = false;
+	}
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+	assert(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size());
+	auto &frame = frames_[frame_id];
+	if (frame.is_evictable_ || frame.size_ == 0) {
+		return;
+	}
+	frame.is_evictable_ = true;
+	evictable_frames_.emplace(GetEvictionKey(frame), frame_id);
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+	assert(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size());
+	auto &frame = frames_[frame_id];
+	if (frame.is_evictable_) {
+		evictable_frames_.erase({GetEvictionKey(frame), frame_id});
+		frame.is_evictable_ = false;
+	}
+	frame.next_ = 0;
+	frame.size_ = 0;
+}
+
+void LRUKReplacer::SortByHotness(std::vector<frame_id_t> &frames) const {
+	// the reverse of the eviction order, frames without any recorded access go last
+	std::stable_sort(frames.begin(), frames.end(), [&](frame_id_t lhs, frame_id_t rhs) {
+		const auto &lhs_frame = frames_[lhs];
+		const auto &rhs_frame = frames_[rhs];
+		if (lhs_frame.size_ == 0 || rhs_frame.size_ == 0) {
+			return lhs_frame.size_ > rhs_frame.size_;
+		}
+		return GetEvictionKey(lhs_frame) > GetEvictionKey(rhs_frame);
+	});
+}
+
+void LRUKReplacer::Print() {
+	for (const auto &[key, frame_id] : evictable_frames_) {
+		LOG_TRACE("frame_id: {} has_k_accesses: {} timestamp: {}", frame_id, key.first, key.second);
+	}
+}
+} // namespace db
@@ -0,0 +1,64 @@
+#include "storage/buffer/page_table.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace db {
+PageTable::PageTable(size_t num_frames) {
+	// at most half full, which keeps probe sequences short
+	auto capacity = std::bit_ceil(std::max<size_t>(2 * num_frames, 8));
+	slots_ = std::make_unique<Slot[]>(capacity);
+	mask_ = capacity - 1;
+	shift_ = 64 - std::countr_zero(capacity);
+}
+
+void PageTable::Insert(PageId page_id, frame_id_t frame_id) {
+	auto key = page_id.Pack();
+	assert(key != EMPTY_KEY && "the invalid page id cannot be cached");
+	auto slot = GetHomeSlot(key);
+	while (true) {
+		auto slot_key = slots_[slot].key_.load(std::memory_order_relaxed);
+		assert(slot_key != key && "page is already in the page table");
+		if (slot_key == EMPTY_KEY) {
+			break;
+		}
+		slot = (slot + 1) & mask_;
+	}
+	// publish the frame before the key so a lock-free reader that sees the key also sees its frame
+	slots_[slot].frame_id_.store(frame_id, std::memory_order_relaxed);
+	slots_[slot].key_.store(key, std::memory_order_release);
+}
+
+bool PageTable::Erase(PageId page_id) {
+	auto key = page_id.Pack();
+	auto hole = GetHomeSlot(key);
+	while (true) {
+		auto slot_key = slots_[hole].key_.load(std::memory_order_relaxed);
+		if (slot_key == EMPTY_KEY) {
+			return false;
+		}
+		if (slot_key == key) {
+			break;
+		}
+		hole = (hole + 1) & mask_;
+	}
+	// shift later entries of the probe sequence back into the hole so lookups never stop early at it
+	for (auto slot = (hole + 1) & mask_;; slot = (slot + 1) & mask_) {
+		auto slot_key = slots_[slot].key_.load(std::memory_order_relaxed);
+		if (slot_key == EMPTY_KEY) {
+			break;
+		}
+		// the entry may move into the hole unless its home slot lies between the hole and its current slot
+		auto home = GetHomeSlot(slot_key);
+		if (((slot - home) & mask_) >= ((slot - hole) & mask_)) {
+			slots_[hole].frame_id_.store(slots_[slot].frame_id_.load(std::memory_order_relaxed),
+			                             std::memory_order_relaxed);
+			slots_[hole].key_.store(slot_key, std::memory_order_release);
+			hole = slot;
+		}
+	}
+	slots_[hole].key_.store(EMPTY_KEY, std::memory_order_release);
+	return true;
+}
+} // namespace db
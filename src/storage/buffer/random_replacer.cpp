@@ -27,4 +27,7 @@ void RandomBogoReplacer::Unpin(frame_id_t frame_id) {
 		it->second = true;
 	}
 }
+void RandomBogoReplacer::Remove(frame_id_t frame_id) {
+	frame_store_.erase(frame_id);
+}
 } // namespace db
@@ -1,88 +1,570 @@
 #include "storage/disk_manager.hpp"
 
 #include "common/config.hpp"
+#include "common/exception.hpp"
 #include "common/fs_utils.hpp"
 #include "common/logger.hpp"
 #include "meta/catalog.hpp"
 #include "storage/file_path_manager.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
-#include <iostream>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
 
 namespace db {
+namespace {
+// reads until size bytes are in or the file ends, returns the number of bytes read
+size_t ReadAt(int fd, char *data, size_t size, off_t offset) {
+	size_t done = 0;
+	while (done < size) {
+		auto n = pread(fd, data + done, size - done, offset + static_cast<off_t>(done));
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw IOException(fmt::format("failed to read from table data file: {}", std::strerror(errno)));
+		}
+		if (n == 0) {
+			break;
+		}
+		done += static_cast<size_t>(n);
+	}
+	return done;
+}
 
-void DiskManager::AddTableDataIfNotExist(table_oid_t table_id) {
-	if (!table_data_files_.contains(table_id)) {
-		fs::path table_data_path;
-		if (table_id == SYSTEM_CATALOG_ID) {
-			table_data_path = FilePathManager::GetInstance().GetSystemCatalogPath();
-		} else {
-			auto table_name = cm_.GetTableName(table_id);
-			table_data_path = FilePathManager::GetInstance().GetTableDataPath(table_name);
-		}
-		auto data_fs = std::fstream(table_data_path, std::ios::binary | std::ios::in | std::ios::out);
-		if (!data_fs.is_open()) {
-			data_fs.clear();
-			// create a new file
-			data_fs.open(table_data_path, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-			if (!data_fs.is_open()) {
-				throw IOException("failed to open table data file");
+void WriteAt(int fd, const char *data, size_t size, off_t offset) {
+	size_t done = 0;
+	while (done < size) {
+		auto n = pwrite(fd, data + done, size - done, offset + static_cast<off_t>(done));
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
 			}
+			throw IOException(fmt::format("failed to write to table data file: {}", std::strerror(errno)));
+		}
+		done += static_cast<size_t>(n);
+	}
+}
+
+// a page buffer aligned for o_direct, which moves data between the device and the buffer without a copy
+struct alignas(PAGE_SIZE) AlignedPage {
+	char data_[PAGE_SIZE];
+};
+
+bool IsMisaligned(const TableFile &file, const void *data) {
+	return file.io_alignment_ != 0 && reinterpret_cast<uintptr_t>(data) % file.io_alignment_ != 0;
+}
+
+// switches the fd to o_direct and returns the buffer alignment it needs, 0 if it stays with the os page cache. the
+// offsets and sizes of the io are multiples of PAGE_SIZE, so only a device whose alignment does not divide it cannot be
+// served
+size_t EnableDirectIo(int fd) {
+	size_t alignment = PAGE_SIZE;
+#ifdef STATX_DIOALIGN
+	struct statx statx_buf;
+	if (statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &statx_buf) == 0 && (statx_buf.stx_mask & STATX_DIOALIGN) != 0) {
+		if (statx_buf.stx_dio_offset_align == 0 || PAGE_SIZE % statx_buf.stx_dio_offset_align != 0 ||
+		    (statx_buf.stx_dio_mem_align != 0 && PAGE_SIZE % statx_buf.stx_dio_mem_align != 0)) {
+			LOG_WARN("table data file does not support direct io with {} byte pages", PAGE_SIZE);
+			return 0;
+		}
+		alignment = std::max<size_t>(statx_buf.stx_dio_mem_align, 1);
+	}
+#endif
+	auto flags = fcntl(fd, F_GETFL);
+	if (flags < 0 || fcntl(fd, F_SETFL, flags | O_DIRECT) != 0) {
+		LOG_WARN("table data file does not support direct io: {}", std::strerror(errno));
+		return 0;
+	}
+	return alignment;
+}
+} // namespace
+
+DiskManager::DiskManager(Catalog &catalog, const DiskManagerConfig &config)
+    : cm_(catalog), io_engine_(IoEngine::Create(config.io_engine_)), extent_size_(config.extent_size_),
+      direct_io_(config.direct_io_), max_open_files_(config.max_open_files_) {
+	if (config.layout_ == StorageLayout::TABLESPACE) {
+		tablespace_ = std::make_unique<Tablespace>(FilePathManager::GetInstance().GetTablespacePath(),
+		                                           FilePathManager::GetInstance().GetTablespaceDirectoryPath());
+		if (direct_io_) {
+			tablespace_io_alignment_ = EnableDirectIo(tablespace_->GetFd());
+		}
+	}
+}
+
+TableFileRef DiskManager::GetTableFile(table_oid_t table_id) {
+	assert(table_id >= SYSTEM_CATALOG_ID);
+	auto idx = static_cast<size_t>(table_id - SYSTEM_CATALOG_ID);
+	// a file is only closed under the exclusive latch once it has no users, a user taken under the shared latch
+	// keeps it open
+	auto use = [&](TableFile &file) { return TableFileRef(file); };
+	{
+		std::shared_lock lock(latch_);
+		if (idx < table_files_.size() && table_files_[idx] != nullptr && table_files_[idx]->fd_ >= 0) {
+			file_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+			return use(*table_files_[idx]);
+		}
+	}
+	std::unique_lock lock(latch_);
+	if (idx >= table_files_.size()) {
+		table_files_.resize(idx + 1);
+	}
+	auto is_open = [&] { return table_files_[idx] != nullptr && table_files_[idx]->fd_ >= 0; };
+	if (is_open()) {
+		file_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+		return use(*table_files_[idx]);
+	}
+	if (tablespace_ != nullptr) {
+		// the tables share the fd of the tablespace, it stays open. the extents are preallocated by the tablespace as
+		// they are allocated
+		file_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+		auto &file = table_files_[idx];
+		file = std::make_unique<TableFile>();
+		file->fd_ = tablespace_->GetFd();
+		file->size_ = tablespace_->GetSize(table_id);
+		file->allocated_ = SIZE_MAX;
+		file->io_alignment_ = tablespace_io_alignment_;
+		return use(*file);
+	}
+	if (max_open_files_ != 0 && num_open_files_ >= max_open_files_) {
+		CloseColdTableFile(lock);
+		// the latch is released while a file is synced before it is closed, the table may have been opened meanwhile
+		if (is_open()) {
+			file_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+			return use(*table_files_[idx]);
+		}
+	}
+	file_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+	auto &file = table_files_[idx];
+	fs::path table_data_path;
+	if (table_id == SYSTEM_CATALOG_ID) {
+		table_data_path = FilePathManager::GetInstance().GetSystemCatalogPath();
+	} else {
+		auto table_name = cm_.GetTableName(table_id);
+		table_data_path = FilePathManager::GetInstance().GetTableDataPath(table_name);
+	}
+	auto fd = open(table_data_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		throw IOException(fmt::format("failed to open table data file {}: {}", table_data_path.string(),
+		                              std::strerror(errno)));
+	}
+	if (file == nullptr) {
+		struct stat stat_buf;
+		if (fstat(fd, &stat_buf) != 0) {
+			close(fd);
+			throw IOException(fmt::format("failed to stat table data file {}: {}", table_data_path.string(),
+			                              std::strerror(errno)));
 		}
-		table_data_files_.emplace(table_id, std::move(data_fs));
+		file = std::make_unique<TableFile>();
+		file->size_ = static_cast<size_t>(stat_buf.st_size);
+		// space reserved past the end before a restart is not known, the first growth reserves from the end again
+		file->allocated_ = file->size_.load();
+	}
+	file->fd_ = fd;
+	file->io_alignment_ = direct_io_ ? EnableDirectIo(fd) : 0;
+	if (max_open_files_ != 0) {
+		file->idle_files_ = &idle_files_;
+	}
+	num_open_files_++;
+	return use(*file);
+}
+
+void DiskManager::CloseColdTableFile(std::unique_lock<std::shared_mutex> &lock) {
+	// no user is added under the exclusive latch, a listed file without users stays without
+	TableFile *victim = idle_files_.PopLeastRecentlyUsed();
+	if (victim == nullptr) {
+		return;
+	}
+	if (victim->needs_sync_.load(std::memory_order_acquire)) {
+		// the user taken here keeps the file open and from being picked by another thread while it is synced
+		TableFileRef ref(*victim);
+		lock.unlock();
+		SyncFiles({victim});
+		lock.lock();
+	}
+	// the file stays open if it was used or written while it was synced
+	if (victim->fd_ < 0 || victim->users_.load(std::memory_order_acquire) != 0 ||
+	    victim->needs_sync_.load(std::memory_order_acquire)) {
+		return;
+	}
+	// the ref of the sync put it back on the list
+	idle_files_.Remove(*victim);
+	close(victim->fd_);
+	victim->fd_ = -1;
+	num_open_files_--;
+}
+
+void IdleTableFiles::Update(TableFile &file) {
+	std::lock_guard lock(latch_);
+	auto is_idle = file.users_.load(std::memory_order_acquire) == 0;
+	if (is_idle == file.is_idle_) {
+		return;
+	}
+	if (is_idle) {
+		file.idle_pos_ = files_.insert(files_.begin(), &file);
+	} else {
+		files_.erase(file.idle_pos_);
+	}
+	file.is_idle_ = is_idle;
+}
+
+void IdleTableFiles::Remove(TableFile &file) {
+	std::lock_guard lock(latch_);
+	if (file.is_idle_) {
+		files_.erase(file.idle_pos_);
+		file.is_idle_ = false;
+	}
+}
+
+TableFile *IdleTableFiles::PopLeastRecentlyUsed() {
+	std::lock_guard lock(latch_);
+	if (files_.empty()) {
+		return nullptr;
+	}
+	auto *file = files_.back();
+	files_.pop_back();
+	file->is_idle_ = false;
+	return file;
+}
+
+void IdleTableFiles::Clear() {
+	std::lock_guard lock(latch_);
+	for (auto *file : files_) {
+		file->is_idle_ = false;
+	}
+	files_.clear();
+}
+
+size_t DiskManager::GetIoAlignment(table_oid_t table_id) {
+	return GetTableFile(table_id)->io_alignment_;
+}
+
+FileCacheStats DiskManager::GetFileCacheStats() {
+	std::shared_lock lock(latch_);
+	return {file_cache_hits_.load(std::memory_order_relaxed), file_cache_misses_.load(std::memory_order_relaxed),
+	        num_open_files_};
+}
+
+DiskIoStats DiskManager::GetIoStats() {
+	std::shared_lock lock(latch_);
+	auto unsynced_files = std::count_if(table_files_.begin(), table_files_.end(), [](const auto &file) {
+		return file != nullptr && file->fd_ >= 0 && file->needs_sync_.load(std::memory_order_acquire);
+	});
+	return {write_requests_.load(std::memory_order_relaxed), syncs_.load(std::memory_order_relaxed),
+	        static_cast<size_t>(unsynced_files)};
+}
+
+off_t DiskManager::GetPageOffset(PageId page_id) {
+	if (tablespace_ != nullptr) {
+		return tablespace_->Locate(page_id, true);
 	}
+	return static_cast<off_t>(page_id.page_number_) * PAGE_SIZE;
+}
+
+uint32_t DiskManager::GetAdjacentPages(PageId page_id, uint32_t count) const {
+	if (tablespace_ == nullptr) {
+		return count;
+	}
+	// the next extent of the table can be anywhere in the tablespace
+	auto offset_in_extent = static_cast<uint32_t>(page_id.page_number_) % TABLESPACE_EXTENT_PAGES;
+	return std::min(count, TABLESPACE_EXTENT_PAGES - offset_in_extent);
+}
+
+void DiskManager::Reserve(TableFile &file, size_t end) const {
+	auto allocated = file.allocated_.load(std::memory_order_acquire);
+	if (extent_size_ == 0 || end <= allocated) {
+		return;
+	}
+	auto new_allocated = (end + extent_size_ - 1) / extent_size_ * extent_size_;
+	// the file keeps its size, reads past the end still see the end of the file rather than zeros. threads racing here
+	// reserve overlapping ranges, which fallocate does not mind
+	while (fallocate(file.fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(allocated),
+	                 static_cast<off_t>(new_allocated - allocated)) != 0) {
+		if (errno == EINTR) {
+			continue;
+		}
+		if (errno == EOPNOTSUPP || errno == ENOSYS) {
+			// the file system cannot preallocate, the file grows with its writes
+			LOG_WARN("table data file does not support preallocation: {}", std::strerror(errno));
+			file.allocated_.store(SIZE_MAX, std::memory_order_release);
+			return;
+		}
+		throw IOException(fmt::format("failed to preallocate table data file: {}", std::strerror(errno)));
+	}
+	TableFile::FetchMax(file.allocated_, new_allocated);
+}
+
+void DiskManager::Extend(TableFile &file, table_oid_t table_id, size_t end) {
+	if (tablespace_ != nullptr && end > file.size_.load(std::memory_order_acquire)) {
+		tablespace_->Extend(table_id, end);
+	}
+	file.Extend(end);
 }
 
 void DiskManager::WritePage(PageId page_id, const char *page_data) {
-	AddTableDataIfNotExist(page_id.table_id_);
+	auto file = GetTableFile(page_id.table_id_);
+	// the aligned copy is only made for direct io, without it every buffer is fine as it is
+	std::unique_ptr<AlignedPage> bounce;
+	if (IsMisaligned(*file, page_data)) {
+		bounce = std::make_unique<AlignedPage>();
+		std::memcpy(bounce->data_, page_data, PAGE_SIZE);
+		page_data = bounce->data_;
+	}
+	auto offset = static_cast<size_t>(page_id.page_number_) * PAGE_SIZE;
+	Reserve(*file, offset + PAGE_SIZE);
+	WriteAt(file->fd_, page_data, PAGE_SIZE, GetPageOffset(page_id));
+	write_requests_.fetch_add(1, std::memory_order_relaxed);
+	Extend(*file, page_id.table_id_, offset + PAGE_SIZE);
+	file->needs_sync_.store(true, std::memory_order_release);
+}
 
-	auto &data_fs = table_data_files_.at(page_id.table_id_);
-	auto offset = page_id.page_number_ * PAGE_SIZE;
-	data_fs.seekp(offset);
-	data_fs.write(page_data, PAGE_SIZE);
-	if (data_fs.bad()) {
-		throw IOException("failed to write to table data file");
+void DiskManager::WritePages(std::span<const PageWrite> writes, bool sync) {
+	std::vector<PageWrite> sorted(writes.begin(), writes.end());
+	std::sort(sorted.begin(), sorted.end(),
+	          [](const PageWrite &lhs, const PageWrite &rhs) { return lhs.page_id_.Pack() < rhs.page_id_.Pack(); });
+	std::vector<iovec> buffers(sorted.size());
+	std::vector<IoRequest> requests;
+	std::vector<TableFileRef> files;
+	std::vector<std::unique_ptr<AlignedPage>> bounces;
+	// table and end of every run in the table, the offsets of the requests are the ones in the file
+	std::vector<std::pair<table_oid_t, size_t>> run_ends;
+	size_t run_begin = 0;
+	while (run_begin < sorted.size()) {
+		auto run_page_id = sorted[run_begin].page_id_;
+		auto max_run_size = GetAdjacentPages(run_page_id, IOV_MAX);
+		auto run_end = run_begin + 1;
+		auto is_next_page = [&](PageId page_id) {
+			auto page_number = run_page_id.page_number_ + static_cast<page_id_t>(run_end - run_begin);
+			return page_id == PageId {run_page_id.table_id_, page_number};
+		};
+		while (run_end < sorted.size() && run_end - run_begin < max_run_size &&
+		       is_next_page(sorted[run_end].page_id_)) {
+			run_end++;
+		}
+		auto file = GetTableFile(run_page_id.table_id_);
+		for (auto i = run_begin; i < run_end; ++i) {
+			const auto *data = sorted[i].data_;
+			if (IsMisaligned(*file, data)) {
+				bounces.push_back(std::make_unique<AlignedPage>());
+				std::memcpy(bounces.back()->data_, data, PAGE_SIZE);
+				data = bounces.back()->data_;
+			}
+			buffers[i] = {const_cast<char *>(data), PAGE_SIZE};
+		}
+		auto run_buffers = std::span<const iovec>(buffers).subspan(run_begin, run_end - run_begin);
+		auto end = (static_cast<size_t>(run_page_id.page_number_) + run_buffers.size()) * PAGE_SIZE;
+		Reserve(*file, end);
+		requests.push_back({file->fd_, GetPageOffset(run_page_id), run_buffers, true});
+		files.push_back(std::move(file));
+		run_ends.emplace_back(run_page_id.table_id_, end);
+		run_begin = run_end;
+	}
+	io_engine_->Submit(requests);
+	write_requests_.fetch_add(requests.size(), std::memory_order_relaxed);
+
+	std::string error;
+	for (size_t i = 0; i < requests.size(); ++i) {
+		const auto &request = requests[i];
+		auto size = static_cast<int64_t>(request.buffers_.size() * PAGE_SIZE);
+		if (request.result_ != size) {
+			error = request.result_ < 0 ? std::strerror(static_cast<int>(-request.result_)) : "short write";
+			continue;
+		}
+		Extend(*files[i], run_ends[i].first, run_ends[i].second);
+		files[i]->needs_sync_.store(true, std::memory_order_release);
+	}
+	if (!error.empty()) {
+		throw IOException(fmt::format("failed to write to table data file: {}", error));
+	}
+	if (sync) {
+		std::vector<TableFile *> written;
+		for (auto &file : files) {
+			written.push_back(&*file);
+		}
+		SyncFiles(std::move(written));
+	}
+}
+
+void DiskManager::Sync() {
+	// the files are synced while latch_ is not held, the users taken here keep them from being closed meanwhile. a
+	// closed file was synced when it was closed
+	std::vector<TableFileRef> refs;
+	{
+		std::shared_lock lock(latch_);
+		for (auto &file : table_files_) {
+			if (file != nullptr && file->fd_ >= 0) {
+				refs.emplace_back(*file);
+			}
+		}
+	}
+	std::vector<TableFile *> files;
+	for (auto &file : refs) {
+		files.push_back(&*file);
+	}
+	SyncFiles(std::move(files));
+}
+
+void DiskManager::SyncFiles(std::vector<TableFile *> files) {
+	// a page is only found through the directory entry of its extent, so the entry has to be durable first
+	if (tablespace_ != nullptr) {
+		tablespace_->SyncDirectory();
+	}
+	std::erase_if(files, [](TableFile *file) { return !file->needs_sync_.exchange(false, std::memory_order_acq_rel); });
+	std::sort(files.begin(), files.end(), [](TableFile *lhs, TableFile *rhs) { return lhs->fd_ < rhs->fd_; });
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (i > 0 && files[i]->fd_ == files[i - 1]->fd_) {
+			continue;
+		}
+		while (fdatasync(files[i]->fd_) != 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			auto error = errno;
+			for (auto *file : files) {
+				file->needs_sync_.store(true, std::memory_order_release);
+			}
+			throw IOException(fmt::format("failed to sync table data file: {}", std::strerror(error)));
+		}
+		syncs_.fetch_add(1, std::memory_order_relaxed);
 	}
-	// flush to sync data
-	data_fs.flush();
 }
 
 void DiskManager::ReadPage(PageId page_id, char *page_data) {
-	AddTableDataIfNotExist(page_id.table_id_);
+	auto file = GetTableFile(page_id.table_id_);
 
 	size_t offset = static_cast<size_t>(page_id.page_number_) * PAGE_SIZE;
-	auto data_file_path = FilePathManager::GetInstance().GetTableDataPath(cm_.GetTableName(page_id.table_id_));
-	if (offset > GetFileSize(data_file_path)) {
-		throw IOException("read page out of file size" + std::to_string(offset) + " " +
-		                  std::to_string(GetFileSize(data_file_path)));
+	auto file_size = file->size_.load(std::memory_order_acquire);
+	if (offset > file_size) {
+		throw IOException("read page out of file size" + std::to_string(offset) + " " + std::to_string(file_size));
+	}
+	std::unique_ptr<AlignedPage> bounce;
+	auto *buffer = page_data;
+	if (IsMisaligned(*file, page_data)) {
+		bounce = std::make_unique<AlignedPage>();
+		buffer = bounce->data_;
 	}
-	auto &data_fs = table_data_files_.at(page_id.table_id_);
-	data_fs.seekp(static_cast<int64_t>(offset));
-	data_fs.read(page_data, PAGE_SIZE);
-	if (data_fs.bad()) {
-		throw IOException("failed to read from table data file");
+	// the tablespace allocates the extent of the page here if it has none yet
+	auto page_offset = GetPageOffset(page_id);
+	size_t num_read = 0;
+	// the page at the end of the file is handed out as a zero page of the extent reserved for it. the file grows by the
+	// page in memory, the page only reaches the disk with its first write
+	if (offset == file_size) {
+		Reserve(*file, offset + PAGE_SIZE);
+		Extend(*file, page_id.table_id_, offset + PAGE_SIZE);
+	} else {
+		num_read = ReadAt(file->fd_, buffer, PAGE_SIZE, page_offset);
 	}
-	// if file ends before reading PAGE_SIZE
-	uint32_t gcount = data_fs.gcount();
-	if (gcount < PAGE_SIZE) {
-		// todo investigate this
-		LOG_ERROR("IO read less than a page, read {} rather than {}", gcount, PAGE_SIZE);
-		data_fs.clear();
-		memset(page_data + gcount, 0, PAGE_SIZE - gcount);
-		data_fs.seekp(static_cast<int64_t>(offset));
-		data_fs.write(page_data, PAGE_SIZE);
+	// a page that was never written reads short, its extent holds zeros for it
+	if (num_read < PAGE_SIZE) {
+		std::memset(buffer + num_read, 0, PAGE_SIZE - num_read);
+	}
+	if (buffer != page_data) {
+		std::memcpy(page_data, buffer, PAGE_SIZE);
 	}
 }
 
-void DiskManager::ShutDown() {
-	for (auto &[table_id, data_fs] : table_data_files_) {
-		data_fs.close();
+void DiskManager::ReadPageRuns(std::span<PageRun> runs) {
+	size_t num_buffers = 0;
+	for (const auto &run : runs) {
+		num_buffers += run.pages_.size();
+	}
+	std::vector<iovec> buffers;
+	buffers.reserve(num_buffers);
+	// a page that is not aligned for direct io is read into an aligned copy first
+	std::vector<std::pair<char *, std::unique_ptr<AlignedPage>>> bounces;
+	// a run is split where its pages stop being adjacent in the file, the tablespace only keeps extents together
+	std::vector<IoRequest> requests;
+	std::vector<size_t> request_runs;
+	std::vector<TableFileRef> files;
+	requests.reserve(runs.size());
+	size_t first_buffer = 0;
+	for (size_t i = 0; i < runs.size(); ++i) {
+		const auto &run = runs[i];
+		auto file = GetTableFile(run.first_page_id_.table_id_);
+		for (auto *page : run.pages_) {
+			if (IsMisaligned(*file, page)) {
+				bounces.emplace_back(page, std::make_unique<AlignedPage>());
+				page = bounces.back().second->data_;
+			}
+			buffers.push_back({page, PAGE_SIZE});
+		}
+		auto num_pages = static_cast<uint32_t>(run.pages_.size());
+		if (tablespace_ != nullptr) {
+			// the extents of the table read as zeros past its last page rather than ending there
+			auto size = file->size_.load(std::memory_order_acquire);
+			auto first = static_cast<size_t>(run.first_page_id_.page_number_) * PAGE_SIZE;
+			num_pages = first >= size ? 0 : std::min(num_pages, static_cast<uint32_t>((size - first) / PAGE_SIZE));
+		}
+		uint32_t done = 0;
+		while (done < num_pages) {
+			auto page_number = run.first_page_id_.page_number_ + static_cast<page_id_t>(done);
+			PageId page_id {run.first_page_id_.table_id_, page_number};
+			auto count = GetAdjacentPages(page_id, num_pages - done);
+			auto offset = tablespace_ != nullptr ? tablespace_->Locate(page_id, false) : GetPageOffset(page_id);
+			if (offset < 0) {
+				break;
+			}
+			requests.push_back({file->fd_, offset, std::span<const iovec>(buffers).subspan(first_buffer + done, count),
+			                    false});
+			request_runs.push_back(i);
+			done += count;
+		}
+		first_buffer += run.pages_.size();
+		files.push_back(std::move(file));
+	}
+	io_engine_->Submit(requests);
+	for (auto &[page, bounce] : bounces) {
+		std::memcpy(page, bounce->data_, PAGE_SIZE);
+	}
+	for (auto &run : runs) {
+		run.num_read_ = 0;
+	}
+	// the pages of a run count up to the first request that failed or came back short
+	std::vector<uint8_t> is_cut(runs.size(), 0);
+	for (size_t i = 0; i < requests.size(); ++i) {
+		auto &run = runs[request_runs[i]];
+		auto result = requests[i].result_;
+		if (is_cut[request_runs[i]] != 0) {
+			continue;
+		}
+		if (result < 0) {
+			LOG_WARN("read of {} failed: {}", run.first_page_id_.ToString(), std::strerror(static_cast<int>(-result)));
+			is_cut[request_runs[i]] = 1;
+			continue;
+		}
+		run.num_read_ += static_cast<uint32_t>(result / PAGE_SIZE);
+		if (static_cast<size_t>(result) < requests[i].buffers_.size() * PAGE_SIZE) {
+			is_cut[request_runs[i]] = 1;
+		}
 	}
-	for (auto &[table_id, meta_fs] : table_meta_files_) {
-		meta_fs.close();
+}
+
+void DiskManager::ShutDown() {
+	std::unique_lock lock(latch_);
+	// the tablespace file is closed with the tablespace
+	if (tablespace_ == nullptr) {
+		for (auto &file : table_files_) {
+			if (file != nullptr && file->fd_ >= 0) {
+				close(file->fd_);
+			}
+		}
 	}
+	idle_files_.Clear();
+	table_files_.clear();
+	num_open_files_ = 0;
 }
 
 DiskManager::~DiskManager() {
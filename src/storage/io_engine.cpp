@@ -0,0 +1,267 @@
+#include "storage/io_engine.hpp"
+
+#include "common/config.hpp"
+#include "common/logger.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <mutex>
+#include <unistd.h>
+#include <vector>
+#ifdef GAVINDB_HAS_IO_URING
+#include <liburing.h>
+#endif
+namespace db {
+namespace {
+// carries out the request from byte done on with blocking calls, returns the bytes transferred in total or -errno
+int64_t TransferFrom(const IoRequest &request, size_t done) {
+	std::vector<iovec> remaining(request.buffers_.begin(), request.buffers_.end());
+	size_t first = 0;
+	auto advance = [&](size_t num_bytes) {
+		while (first < remaining.size() && num_bytes >= remaining[first].iov_len) {
+			num_bytes -= remaining[first].iov_len;
+			first++;
+		}
+		if (first < remaining.size()) {
+			remaining[first].iov_base = static_cast<char *>(remaining[first].iov_base) + num_bytes;
+			remaining[first].iov_len -= num_bytes;
+		}
+	};
+	advance(done);
+	while (first < remaining.size()) {
+		auto num_buffers = static_cast<int>(std::min(remaining.size() - first, static_cast<size_t>(IOV_MAX)));
+		auto offset = request.offset_ + static_cast<off_t>(done);
+		auto n = request.is_write_ ? pwritev(request.fd_, &remaining[first], num_buffers, offset)
+		                           : preadv(request.fd_, &remaining[first], num_buffers, offset);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -errno;
+		}
+		// end of the file
+		if (n == 0) {
+			break;
+		}
+		done += static_cast<size_t>(n);
+		advance(static_cast<size_t>(n));
+	}
+	return static_cast<int64_t>(done);
+}
+
+class SyncIoEngine : public IoEngine {
+public:
+	void Submit(std::span<IoRequest> requests) override {
+		for (auto &request : requests) {
+			request.result_ = TransferFrom(request, 0);
+		}
+	}
+	[[nodiscard]] IoEngineType GetType() const override {
+		return IoEngineType::SYNC;
+	}
+};
+
+#ifdef GAVINDB_HAS_IO_URING
+class IoUringEngine : public IoEngine {
+public:
+	IoUringEngine() = default;
+	IoUringEngine(const IoUringEngine &) = delete;
+	IoUringEngine &operator=(const IoUringEngine &) = delete;
+	~IoUringEngine() override {
+		for (auto &ring : rings_) {
+			if (ring.is_set_up_) {
+				io_uring_queue_exit(&ring.ring_);
+			}
+		}
+	}
+
+	// returns the error of the first ring that could not be set up, 0 on success
+	int SetUp() {
+		for (auto &ring : rings_) {
+			if (auto ret = io_uring_queue_init(IO_URING_QUEUE_DEPTH, &ring.ring_, 0); ret < 0) {
+				return ret;
+			}
+			ring.is_set_up_ = true;
+		}
+		return 0;
+	}
+
+	void Submit(std::span<IoRequest> requests) override {
+		// the IO_URING_NUM_RINGS rings are shared by all submitting threads and run one batch at a time. threads get a
+		// home ring round-robin, try the rings from there on and only block on the home ring when every ring is busy
+		static std::atomic<size_t> next_ring {0};
+		thread_local const size_t home_ring = next_ring.fetch_add(1, std::memory_order_relaxed);
+		auto *ring = &rings_[home_ring % rings_.size()];
+		std::unique_lock lock(ring->latch_, std::try_to_lock);
+		for (size_t i = 1; i < rings_.size() && !lock.owns_lock(); ++i) {
+			ring = &rings_[(home_ring + i) % rings_.size()];
+			lock = std::unique_lock(ring->latch_, std::try_to_lock);
+		}
+		if (!lock.owns_lock()) {
+			ring = &rings_[home_ring % rings_.size()];
+			lock = std::unique_lock(ring->latch_);
+		}
+		// a readv or writev takes at most IOV_MAX buffers like preadv does, longer requests go in parts
+		std::vector<IoRequest> parts;
+		for (auto &request : requests) {
+			off_t offset = request.offset_;
+			for (size_t first = 0; first < request.buffers_.size(); first += IOV_MAX) {
+				auto count = std::min<size_t>(IOV_MAX, request.buffers_.size() - first);
+				auto buffers = request.buffers_.subspan(first, count);
+				parts.push_back({request.fd_, offset, buffers, request.is_write_, NOT_COMPLETED});
+				for (const auto &buffer : buffers) {
+					offset += static_cast<off_t>(buffer.iov_len);
+				}
+			}
+		}
+		if (ring->is_set_up_) {
+			Run(*ring, parts);
+		}
+		// a request transferred what its parts did up to the first that failed or came back short
+		size_t next_part = 0;
+		for (auto &request : requests) {
+			int64_t done = 0;
+			request.result_ = NOT_COMPLETED;
+			for (size_t first = 0; first < request.buffers_.size(); first += IOV_MAX) {
+				const auto &part = parts[next_part++];
+				if (request.result_ != NOT_COMPLETED) {
+					continue;
+				}
+				if (part.result_ < 0) {
+					request.result_ = done > 0 ? done : part.result_;
+				} else if (static_cast<size_t>(part.result_) < GetSize(part)) {
+					request.result_ = done + part.result_;
+				} else {
+					done += part.result_;
+				}
+			}
+			if (request.result_ == NOT_COMPLETED) {
+				request.result_ = done;
+			}
+		}
+		for (auto &request : requests) {
+			// a failed ring leaves requests behind, a short transfer before the end of the file is finished off
+			if (request.result_ == NOT_COMPLETED) {
+				request.result_ = TransferFrom(request, 0);
+			} else if (request.result_ > 0 && static_cast<size_t>(request.result_) < GetSize(request)) {
+				request.result_ = TransferFrom(request, static_cast<size_t>(request.result_));
+			}
+		}
+	}
+	[[nodiscard]] IoEngineType GetType() const override {
+		return IoEngineType::IO_URING;
+	}
+
+private:
+	static constexpr int64_t NOT_COMPLETED = INT64_MIN;
+
+	[[nodiscard]] static size_t GetSize(const IoRequest &request) {
+		size_t size = 0;
+		for (const auto &buffer : request.buffers_) {
+			size += buffer.iov_len;
+		}
+		return size;
+	}
+
+	struct Ring {
+		std::mutex latch_;
+		io_uring ring_ {};
+		bool is_set_up_ {false};
+	};
+
+	static void Run(Ring &ring, std::span<IoRequest> requests) {
+		size_t next = 0;
+		uint32_t num_queued = 0;
+		uint32_t num_in_flight = 0;
+		while (next < requests.size() || num_queued > 0 || num_in_flight > 0) {
+			while (next < requests.size() && num_queued + num_in_flight < IO_URING_QUEUE_DEPTH) {
+				auto *sqe = io_uring_get_sqe(&ring.ring_);
+				if (sqe == nullptr) {
+					break;
+				}
+				auto &request = requests[next++];
+				auto num_buffers = static_cast<unsigned>(request.buffers_.size());
+				if (request.is_write_) {
+					io_uring_prep_writev(sqe, request.fd_, request.buffers_.data(), num_buffers, request.offset_);
+				} else {
+					io_uring_prep_readv(sqe, request.fd_, request.buffers_.data(), num_buffers, request.offset_);
+				}
+				io_uring_sqe_set_data(sqe, &request);
+				num_queued++;
+			}
+			if (num_queued > 0) {
+				auto ret = io_uring_submit(&ring.ring_);
+				if (ret >= 0) {
+					num_queued -= static_cast<uint32_t>(ret);
+					num_in_flight += static_cast<uint32_t>(ret);
+				} else if (ret != -EINTR && (num_in_flight == 0 || (ret != -EAGAIN && ret != -EBUSY))) {
+					Reset(ring, num_in_flight, ret);
+					return;
+				}
+			}
+			// an interrupted submit may have handed nothing over, there is no completion to wait for then
+			if (num_in_flight == 0) {
+				continue;
+			}
+			io_uring_cqe *cqe = nullptr;
+			auto ret = io_uring_wait_cqe(&ring.ring_, &cqe);
+			if (ret < 0) {
+				if (ret != -EINTR) {
+					Reset(ring, num_in_flight, ret);
+					return;
+				}
+				continue;
+			}
+			do {
+				static_cast<IoRequest *>(io_uring_cqe_get_data(cqe))->result_ = cqe->res;
+				io_uring_cqe_seen(&ring.ring_, cqe);
+				num_in_flight--;
+			} while (io_uring_peek_cqe(&ring.ring_, &cqe) == 0);
+		}
+	}
+
+	// waits for the requests the kernel already has and sets the ring up again, the queued ones go with the old ring
+	static void Reset(Ring &ring, uint32_t num_in_flight, int error) {
+		LOG_WARN("io_uring failed: {}, finishing the batch with blocking io", std::strerror(-error));
+		while (num_in_flight > 0) {
+			io_uring_cqe *cqe = nullptr;
+			auto ret = io_uring_wait_cqe(&ring.ring_, &cqe);
+			if (ret == -EINTR) {
+				continue;
+			}
+			if (ret < 0) {
+				break;
+			}
+			static_cast<IoRequest *>(io_uring_cqe_get_data(cqe))->result_ = cqe->res;
+			io_uring_cqe_seen(&ring.ring_, cqe);
+			num_in_flight--;
+		}
+		io_uring_queue_exit(&ring.ring_);
+		ring.is_set_up_ = io_uring_queue_init(IO_URING_QUEUE_DEPTH, &ring.ring_, 0) == 0;
+	}
+
+	std::array<Ring, IO_URING_NUM_RINGS> rings_;
+};
+#endif
+} // namespace
+
+std::unique_ptr<IoEngine> IoEngine::Create(IoEngineType type) {
+	if (type == IoEngineType::IO_URING) {
+#ifdef GAVINDB_HAS_IO_URING
+		auto engine = std::make_unique<IoUringEngine>();
+		auto ret = engine->SetUp();
+		if (ret == 0) {
+			return engine;
+		}
+		LOG_WARN("Failed to set up io_uring: {}, using blocking io", std::strerror(-ret));
+#else
+		LOG_WARN("Built without liburing, using blocking io");
+#endif
+	}
+	return std::make_unique<SyncIoEngine>();
+}
+} // namespace db
@@ -2,6 +2,8 @@
 
 #include "storage/buffer/buffer_pool.hpp"
 
+#include <thread>
+
 namespace db {
 
 BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept {
@@ -17,7 +19,7 @@ void BasicPageGuard::Drop() {
 		return;
 	}
 
-	bpm_->UnpinPage(page_->GetPageId(), is_dirty_);
+	bpm_->UnpinPage(*page_, is_dirty_);
 	page_ = nullptr;
 	bpm_ = nullptr;
 }
@@ -90,6 +92,16 @@ WritePageGuard::~WritePageGuard() {
 	Drop();
 }
 
+OptimisticReadGuard::OptimisticReadGuard(Page &page, PageId page_id)
+    : page_(&page), page_id_(page_id), version_(page.GetVersion()) {
+	// give a writer that is about to finish a few chances before the guard is left to fail its validation
+	for (uint32_t attempt = 1; attempt < OPTIMISTIC_READ_RETRIES && ReaderWriterLatch::IsWriteLocked(version_);
+	     ++attempt) {
+		std::this_thread::yield();
+		version_ = page.GetVersion();
+	}
+}
+
 auto BasicPageGuard::UpgradeRead() -> ReadPageGuard {
 	page_->RLatch();
 
@@ -71,8 +71,8 @@ void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid) {
 	page.UpdateTupleMeta(meta, rid);
 };
 
-std::optional<std::pair<TupleMeta, Tuple>> TableHeap::GetTuple(RID rid) const {
-	auto page_guard = bpm_.FetchPageRead(rid.GetPageId());
+std::optional<std::pair<TupleMeta, Tuple>> TableHeap::GetTuple(RID rid, BufferAccessStrategy *strategy) const {
+	auto page_guard = bpm_.FetchPageRead(rid.GetPageId(), strategy);
 	const auto &page = page_guard.As<TablePage>();
 	auto ret = page.GetTuple(rid);
 	if (!ret.has_value()) {
@@ -100,8 +100,13 @@ TableIterator TableHeap::MakeIterator() {
 	const auto &page = page_guard.As<TablePage>();
 	auto num_tuples = page.GetNumTuples();
 	page_guard.Drop();
+	// a scan over a large part of the pool would push out everyone else's pages, confine it to a ring
+	std::unique_ptr<BufferAccessStrategy> strategy;
+	if (static_cast<size_t>(last_page_id) > static_cast<size_t>(bpm_.GetPoolSize()) / BULK_READ_POOL_FRACTION) {
+		strategy = bpm_.MakeBulkReadStrategy();
+	}
 	// iterate from rid 0, 0 to last_page_id and num_tuples
-	return TableIterator {*this, {{table_oid, 1}, 0}, {{table_oid, last_page_id}, num_tuples}};
+	return TableIterator {*this, {{table_oid, 1}, 0}, {{table_oid, last_page_id}, num_tuples}, std::move(strategy)};
 }
 
 } // namespace db
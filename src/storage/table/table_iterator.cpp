@@ -2,6 +2,7 @@
 #include "storage/page/table_page.hpp"
 #include "storage/table/table_heap.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <optional>
 
@@ -9,7 +10,7 @@ namespace db {
 
 std::optional<std::pair<TupleMeta, Tuple>> TableIterator::GetTuple() {
 	LOG_TRACE("{}", rid_.ToString());
-	return table_heap_.GetTuple(rid_);
+	return table_heap_.GetTuple(rid_, strategy_.get());
 }
 
 auto TableIterator::GetRID() -> RID {
@@ -21,7 +22,8 @@ auto TableIterator::IsEnd() -> bool {
 }
 
 TableIterator &TableIterator::operator++() {
-	auto page_guard = table_heap_.bpm_.FetchPageRead(rid_.GetPageId());
+	auto page_guard_page_number = rid_.GetPageId().page_number_;
+	auto page_guard = table_heap_.bpm_.FetchPageRead(rid_.GetPageId(), strategy_.get());
 	const auto &page = page_guard.As<TablePage>();
 	auto next_tuple_id = rid_.GetSlotNum() + 1;
 
@@ -44,6 +46,11 @@ TableIterator &TableIterator::operator++() {
 		auto next_page_id = page.GetNextPageId();
 		// if next page is invalid, RID is set to invalid page; otherwise, it's the first tuple in that page.
 		rid_ = RID {{table_heap_.table_meta_.table_oid_, next_page_id}, 0};
+		page_guard.Drop();
+		if (next_page_id != INVALID_PAGE_ID) {
+			ReadAhead(page_guard_page_number, next_page_id);
+		}
+		return *this;
 	}
 
 	page_guard.Drop();
@@ -51,4 +58,30 @@ TableIterator &TableIterator::operator++() {
 	return *this;
 }
 
+void TableIterator::ReadAhead(page_id_t prev_page_number, page_id_t page_number) {
+	auto stop_page_number = stop_at_rid_.GetPageId().page_number_;
+	// heap pages are mostly allocated back to back, only a chain that moves forward through the file is read ahead
+	if (stop_page_number == INVALID_PAGE_ID || page_number != prev_page_number + 1) {
+		read_ahead_end_ = page_number;
+		return;
+	}
+	// a ring recycles its oldest frame on every miss and the whole window may hash to one shard, keep the window
+	// within the ring of a shard so that pages read ahead survive until the cursor gets to them
+	page_id_t window = READ_AHEAD_PAGES;
+	if (strategy_ != nullptr) {
+		window = std::min<page_id_t>(window, static_cast<page_id_t>(strategy_->GetShardRingSize()));
+	}
+	// refill once the cursor has consumed half of the window
+	if (page_number + window / 2 <= read_ahead_end_) {
+		return;
+	}
+	auto begin = std::max(page_number, read_ahead_end_ + 1);
+	auto end = std::min(page_number + window - 1, stop_page_number);
+	if (begin > end) {
+		return;
+	}
+	table_heap_.bpm_.PrefetchPages({table_heap_.table_meta_.table_oid_, begin}, end - begin + 1, strategy_.get());
+	read_ahead_end_ = end;
+}
+
 } // namespace db
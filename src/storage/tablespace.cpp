@@ -0,0 +1,209 @@
+#include "storage/tablespace.hpp"
+
+#include "common/exception.hpp"
+#include "common/fs_utils.hpp"
+#include "common/logger.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace db {
+namespace {
+int OpenFile(const std::filesystem::path &path) {
+	CreateFolderIfNotExists(path.parent_path());
+	auto fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		throw IOException(fmt::format("failed to open tablespace file {}: {}", path.string(), std::strerror(errno)));
+	}
+	return fd;
+}
+} // namespace
+
+Tablespace::Tablespace(const std::filesystem::path &data_path, const std::filesystem::path &directory_path)
+    : fd_(OpenFile(data_path)), directory_fd_(OpenFile(directory_path)) {
+	try {
+		ReadDirectory(directory_path);
+	} catch (...) {
+		close(fd_);
+		close(directory_fd_);
+		throw;
+	}
+	LOG_DEBUG("opened tablespace with {} extents of {} tables", num_extents_, extents_.size());
+}
+
+Tablespace::~Tablespace() {
+	// a clean close keeps the sizes for the next open, only SyncDirectory makes them durable
+	try {
+		for (const auto &[physical_extent, entry] : TakeResizedEntries()) {
+			WriteEntry(physical_extent, entry);
+		}
+	} catch (const std::exception &e) {
+		LOG_ERROR("failed to write tablespace directory on close: {}", e.what());
+	}
+	close(fd_);
+	close(directory_fd_);
+}
+
+void Tablespace::ReadDirectory(const std::filesystem::path &directory_path) {
+	struct stat stat_buf;
+	if (fstat(directory_fd_, &stat_buf) != 0) {
+		throw IOException(fmt::format("failed to stat tablespace directory {}: {}", directory_path.string(),
+		                              std::strerror(errno)));
+	}
+	auto file_size = static_cast<size_t>(stat_buf.st_size);
+	DirectoryHeader header {};
+	if (file_size == 0) {
+		header = {DIRECTORY_MAGIC, DIRECTORY_VERSION, 0};
+		if (pwrite(directory_fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+			throw IOException("failed to write tablespace directory: " + directory_path.string());
+		}
+		directory_needs_sync_ = true;
+		return;
+	}
+	if (file_size < sizeof(header) || pread(directory_fd_, &header, sizeof(header), 0) != sizeof(header) ||
+	    header.magic_ != DIRECTORY_MAGIC) {
+		throw IOException("not a tablespace directory: " + directory_path.string());
+	}
+	if (header.version_ != DIRECTORY_VERSION) {
+		throw IOException(fmt::format("tablespace directory {} has version {}, expected version {}",
+		                              directory_path.string(), header.version_, DIRECTORY_VERSION));
+	}
+	if ((file_size - sizeof(header)) % sizeof(DirectoryEntry) != 0) {
+		throw IOException("tablespace directory is corrupted: " + directory_path.string());
+	}
+	std::vector<DirectoryEntry> entries((file_size - sizeof(header)) / sizeof(DirectoryEntry));
+	auto size = entries.size() * sizeof(DirectoryEntry);
+	if (size != 0 && pread(directory_fd_, entries.data(), size, sizeof(header)) != static_cast<ssize_t>(size)) {
+		throw IOException("failed to read tablespace directory: " + directory_path.string());
+	}
+	for (const auto &entry : entries) {
+		auto &extents = extents_[entry.table_id_];
+		if (entry.extent_ >= extents.size()) {
+			extents.resize(entry.extent_ + 1, UNALLOCATED_EXTENT);
+		}
+		extents[entry.extent_] = num_extents_++;
+		auto end = (static_cast<size_t>(entry.extent_) * TABLESPACE_EXTENT_PAGES + entry.num_pages_) * PAGE_SIZE;
+		auto &table_size = sizes_[entry.table_id_];
+		table_size = std::max(table_size, end);
+	}
+}
+
+off_t Tablespace::Locate(PageId page_id, bool allocate) {
+	auto extent = static_cast<uint32_t>(page_id.page_number_) / TABLESPACE_EXTENT_PAGES;
+	auto offset_in_extent = static_cast<off_t>(page_id.page_number_ % TABLESPACE_EXTENT_PAGES) * PAGE_SIZE;
+	{
+		std::shared_lock lock(latch_);
+		auto it = extents_.find(page_id.table_id_);
+		if (it != extents_.end() && extent < it->second.size() && it->second[extent] != UNALLOCATED_EXTENT) {
+			return static_cast<off_t>(it->second[extent]) * EXTENT_SIZE + offset_in_extent;
+		}
+	}
+	if (!allocate) {
+		return -1;
+	}
+	return AllocateExtent(page_id.table_id_, extent) + offset_in_extent;
+}
+
+off_t Tablespace::AllocateExtent(table_oid_t table_id, uint32_t extent) {
+	std::unique_lock lock(latch_);
+	auto &extents = extents_[table_id];
+	if (extent < extents.size() && extents[extent] != UNALLOCATED_EXTENT) {
+		return static_cast<off_t>(extents[extent]) * EXTENT_SIZE;
+	}
+	auto physical_extent = num_extents_;
+	auto offset = static_cast<off_t>(physical_extent) * EXTENT_SIZE;
+	// reserve the extent as a whole, a file system without preallocation gets a sparse one
+	int ret;
+	while ((ret = fallocate(fd_, 0, offset, EXTENT_SIZE)) != 0 && errno == EINTR) {
+	}
+	if (ret != 0 && (errno != EOPNOTSUPP || ftruncate(fd_, offset + static_cast<off_t>(EXTENT_SIZE)) != 0)) {
+		throw IOException(fmt::format("failed to allocate tablespace extent: {}", std::strerror(errno)));
+	}
+	// an extent whose entry did not make it to the directory before a crash is handed out again after the restart
+	WriteEntry(physical_extent, {table_id, extent, 0});
+	if (extent >= extents.size()) {
+		extents.resize(extent + 1, UNALLOCATED_EXTENT);
+	}
+	extents[extent] = physical_extent;
+	num_extents_++;
+	directory_needs_sync_ = true;
+	return offset;
+}
+
+void Tablespace::WriteEntry(uint32_t physical_extent, const DirectoryEntry &entry) {
+	auto offset = static_cast<off_t>(sizeof(DirectoryHeader)) +
+	              static_cast<off_t>(physical_extent) * static_cast<off_t>(sizeof(DirectoryEntry));
+	if (pwrite(directory_fd_, &entry, sizeof(entry), offset) != static_cast<ssize_t>(sizeof(entry))) {
+		throw IOException(fmt::format("failed to write tablespace directory: {}", std::strerror(errno)));
+	}
+}
+
+size_t Tablespace::GetSize(table_oid_t table_id) {
+	std::shared_lock lock(latch_);
+	auto it = sizes_.find(table_id);
+	return it == sizes_.end() ? 0 : it->second;
+}
+
+void Tablespace::Extend(table_oid_t table_id, size_t end) {
+	std::unique_lock lock(latch_);
+	auto &size = sizes_[table_id];
+	if (end <= size) {
+		return;
+	}
+	size = end;
+	resized_tables_.insert(table_id);
+	directory_needs_sync_ = true;
+}
+
+auto Tablespace::TakeResizedEntries() -> std::vector<std::pair<uint32_t, DirectoryEntry>> {
+	std::vector<std::pair<uint32_t, DirectoryEntry>> entries;
+	for (auto table_id : resized_tables_) {
+		auto last_page = static_cast<uint32_t>((sizes_[table_id] - 1) / PAGE_SIZE);
+		auto extent = last_page / TABLESPACE_EXTENT_PAGES;
+		const auto &extents = extents_[table_id];
+		assert(extent < extents.size() && extents[extent] != UNALLOCATED_EXTENT);
+		auto num_pages = last_page % TABLESPACE_EXTENT_PAGES + 1;
+		entries.emplace_back(extents[extent], DirectoryEntry {table_id, extent, num_pages});
+	}
+	resized_tables_.clear();
+	return entries;
+}
+
+void Tablespace::SyncDirectory() {
+	std::lock_guard sync_lock(sync_latch_);
+	std::vector<std::pair<uint32_t, DirectoryEntry>> entries;
+	{
+		std::unique_lock lock(latch_);
+		if (!directory_needs_sync_) {
+			return;
+		}
+		entries = TakeResizedEntries();
+		directory_needs_sync_ = false;
+	}
+	// extents allocated in the meantime write their own entries, which never share a slot with a resized table's
+	try {
+		for (const auto &[physical_extent, entry] : entries) {
+			WriteEntry(physical_extent, entry);
+		}
+		while (fdatasync(directory_fd_) != 0) {
+			if (errno != EINTR) {
+				throw IOException(fmt::format("failed to sync tablespace directory: {}", std::strerror(errno)));
+			}
+		}
+	} catch (...) {
+		// the next sync writes them again
+		std::unique_lock lock(latch_);
+		for (const auto &[physical_extent, entry] : entries) {
+			resized_tables_.insert(entry.table_id_);
+		}
+		directory_needs_sync_ = true;
+		throw;
+	}
+}
+} // namespace db
@@ -8,7 +8,10 @@
 #include "storage/table/table_heap.hpp"
 
 #include "gtest/gtest.h"
+#include <atomic>
 #include <cstdint>
+#include <thread>
+#include <vector>
 namespace db {
 
 TEST(IndexTest, IndexTest) {
@@ -150,4 +153,90 @@ TEST(IndexTest, IndexManyInsertionsTest) {
 		}
 	}
 }
+
+TEST(IndexTest, OptimisticSearchDuringInsertions) {
+	const size_t buffer_pool_size = 64;
+	auto cm = std::make_unique<db::Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<db::BufferPool>(buffer_pool_size, *dm);
+
+	auto schema = db::Schema({db::Column("user_id", db::TypeId::INTEGER)});
+	cm->CreateTable("user", schema);
+	auto &table_meta = cm->GetTableByName("user");
+	auto index_meta = std::make_unique<IndexMeta>("user_id_index", table_meta.table_oid_, schema.GetColumn(0),
+	                                              IndexConstraintType::PRIMARY, IndexType::BPlusTreeIndex);
+	auto btree_index = std::make_unique<BTreeIndex>(*index_meta, table_meta, *bpm);
+
+	constexpr int n = 5000;
+	std::vector<Tuple> tuples;
+	for (int i = 0; i < n; ++i) {
+		tuples.emplace_back(std::vector<Value> {Value(db::TypeId::INTEGER, i)}, schema);
+	}
+
+	// readers look up keys that are already inserted while the writer keeps splitting nodes under them
+	std::atomic<int> num_inserted = 0;
+	std::atomic<bool> all_found = true;
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 2; ++t) {
+		readers.emplace_back([&] {
+			while (num_inserted.load() < n) {
+				auto upper = num_inserted.load();
+				for (int i = std::max(0, upper - 100); i < upper; ++i) {
+					std::vector<RID> scan_ans;
+					if (!btree_index->ScanKey(tuples[i], scan_ans) || scan_ans[0] != RID({0, i}, 0)) {
+						all_found = false;
+					}
+				}
+			}
+		});
+	}
+	Transaction txn {1, IsolationLevel::READ_UNCOMMITTED};
+	for (int i = 0; i < n; ++i) {
+		btree_index->InsertRecord(txn, tuples[i], RID({0, i}, 0));
+		num_inserted.store(i + 1);
+	}
+	for (auto &reader : readers) {
+		reader.join();
+	}
+	ASSERT_TRUE(all_found);
+}
+
+TEST(IndexTest, SwizzledSearchSkipsPageTable) {
+	auto cm = std::make_unique<db::Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto schema = db::Schema({db::Column("user_id", db::TypeId::INTEGER)});
+	cm->CreateTable("user", schema);
+	auto &table_meta = cm->GetTableByName("user");
+	constexpr int n = 5000;
+	std::vector<Tuple> tuples;
+	for (int i = 0; i < n; ++i) {
+		tuples.emplace_back(std::vector<Value> {Value(db::TypeId::INTEGER, i)}, schema);
+	}
+
+	// a small pool keeps evicting nodes whose frames are still referenced by their parents
+	for (size_t buffer_pool_size : {12, 256}) {
+		auto bpm = std::make_unique<db::BufferPool>(buffer_pool_size, *dm);
+		auto index_meta = std::make_unique<IndexMeta>("user_id_index", table_meta.table_oid_, schema.GetColumn(0),
+		                                              IndexConstraintType::PRIMARY, IndexType::BPlusTreeIndex);
+		auto btree_index = std::make_unique<BTreeIndex>(*index_meta, table_meta, *bpm, true);
+		Transaction txn {1, IsolationLevel::READ_UNCOMMITTED};
+		for (int i = 0; i < n; ++i) {
+			btree_index->InsertRecord(txn, tuples[i], RID({0, i}, 0));
+		}
+		for (int pass = 0; pass < 2; ++pass) {
+			auto before = bpm->GetMetrics();
+			for (int i = 0; i < n; ++i) {
+				std::vector<RID> scan_ans;
+				ASSERT_TRUE(btree_index->ScanKey(tuples[i], scan_ans));
+				ASSERT_EQ(scan_ans[0], RID({0, i}, 0));
+			}
+			auto after = bpm->GetMetrics();
+			if (buffer_pool_size == 256 && pass == 1) {
+				// every step below the header, root to leaf, follows a reference of the cached tree
+				ASSERT_EQ(after.misses_, before.misses_);
+				ASSERT_GE(after.swizzled_hits_ - before.swizzled_hits_, 2 * n);
+			}
+		}
+	}
+}
 } // namespace db
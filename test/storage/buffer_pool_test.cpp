@@ -0,0 +1,658 @@
+#include "common/exception.hpp"
+#include "common/fs_utils.hpp"
+#include "common/logger.hpp"
+#include "common/test_utils.hpp"
+#include "meta/catalog.hpp"
+#include "storage/buffer/buffer_pool.hpp"
+#include "storage/buffer/buffer_pool_set.hpp"
+#include "storage/file_path_manager.hpp"
+#include "storage/page_allocator.hpp"
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace db {
+
+TEST(BufferPoolTest, ShardedPoolKeepsPageContents) {
+	for (auto replacer_type : {ReplacerType::LRU_K, ReplacerType::CLOCK}) {
+		DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+		const frame_id_t buffer_pool_size = 16;
+		auto cm = std::make_unique<Catalog>();
+		auto dm = std::make_unique<DiskManager>(*cm);
+		auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, replacer_type, 4);
+		ASSERT_EQ(bpm->GetNumShards(), 4);
+		auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+		// write more pages than the pool holds so every shard has to evict
+		std::vector<PageId> page_ids;
+		for (int i = 0; i < 64; ++i) {
+			PageId page_id;
+			auto guard = bpm->NewPageGuarded(allocator, page_id);
+			std::memcpy(guard.GetDataMut(), &i, sizeof(i));
+			page_ids.push_back(page_id);
+		}
+
+		for (int i = 0; i < 64; ++i) {
+			auto guard = bpm->FetchPageRead(page_ids[i]);
+			ASSERT_EQ(guard.As<int>(), i);
+		}
+	}
+}
+
+TEST(BufferPoolTest, ConcurrentMissesDoNotLoseWrites) {
+	for (auto replacer_type : {ReplacerType::LRU_K, ReplacerType::CLOCK}) {
+		DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+		const frame_id_t buffer_pool_size = 16;
+		const int num_pages = 64;
+		const int num_threads = 4;
+		const int updates_per_thread = 2000;
+		auto cm = std::make_unique<Catalog>();
+		auto dm = std::make_unique<DiskManager>(*cm);
+		auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, replacer_type, 4);
+		auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+		std::vector<PageId> page_ids;
+		for (int i = 0; i < num_pages; ++i) {
+			PageId page_id;
+			bpm->NewPageGuarded(allocator, page_id);
+			page_ids.push_back(page_id);
+		}
+
+		// every update goes through an eviction-heavy pool, dirty victims are written back and read in concurrently
+		std::vector<std::thread> threads;
+		for (int t = 0; t < num_threads; ++t) {
+			threads.emplace_back([&, t] {
+				std::mt19937 gen(t);
+				std::uniform_int_distribution<> dist(0, num_pages - 1);
+				for (int i = 0; i < updates_per_thread; ++i) {
+					auto guard = bpm->FetchPageWrite(page_ids[dist(gen)]);
+					guard.AsMut<int>()++;
+				}
+			});
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		int total = 0;
+		for (const auto &page_id : page_ids) {
+			total += bpm->FetchPageRead(page_id).As<int>();
+		}
+		ASSERT_EQ(total, num_threads * updates_per_thread);
+	}
+}
+
+TEST(BufferPoolTest, ConcurrentPinsKeepCountsAndWriteBack) {
+	for (auto replacer_type : {ReplacerType::LRU_K, ReplacerType::CLOCK}) {
+		DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+		const frame_id_t buffer_pool_size = 32;
+		const int num_pages = 128;
+		const int num_threads = 4;
+		const int rounds_per_thread = 2000;
+		auto cm = std::make_unique<Catalog>();
+		auto dm = std::make_unique<DiskManager>(*cm);
+		auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, replacer_type, 2);
+		auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+		std::vector<PageId> page_ids;
+		for (int i = 0; i < num_pages; ++i) {
+			PageId page_id;
+			bpm->NewPageGuarded(allocator, page_id);
+			page_ids.push_back(page_id);
+		}
+
+		// the threads share a few hot pages that they pin and unpin without the shard latch, while the updates of the
+		// others keep evicting frames
+		std::atomic<bool> frames_kept = true;
+		std::vector<std::thread> threads;
+		for (int t = 0; t < num_threads; ++t) {
+			threads.emplace_back([&, t] {
+				std::mt19937 gen(t);
+				std::uniform_int_distribution<> hot_dist(0, 3);
+				std::uniform_int_distribution<> dist(4, num_pages - 1);
+				for (int i = 0; i < rounds_per_thread; ++i) {
+					auto hot_page_id = page_ids[hot_dist(gen)];
+					auto pinned = bpm->FetchPageBasic(hot_page_id);
+					{
+						auto guard = bpm->FetchPageWrite(page_ids[dist(gen)]);
+						guard.AsMut<int>()++;
+					}
+					// a pinned frame is never taken over, a second pin finds it where the first one left it
+					auto again = bpm->FetchPageBasic(hot_page_id);
+					if (again.GetData() != pinned.GetData()) {
+						frames_kept = false;
+					}
+				}
+			});
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+		ASSERT_TRUE(frames_kept);
+
+		// a frame with a pin left over cannot be deleted
+		bpm->FlushAllPages();
+		ASSERT_EQ(bpm->GetNumDirtyPages(), 0);
+		for (const auto &page_id : page_ids) {
+			ASSERT_TRUE(bpm->DeletePage(page_id));
+		}
+		// every update reached the disk, whether its page was evicted dirty or flushed
+		int total = 0;
+		std::array<char, PAGE_SIZE> data;
+		for (const auto &page_id : page_ids) {
+			dm->ReadPage(page_id, data.data());
+			int value;
+			std::memcpy(&value, data.data(), sizeof(value));
+			total += value;
+		}
+		ASSERT_EQ(total, num_threads * rounds_per_thread);
+	}
+}
+
+TEST(BufferPoolTest, BackgroundWriterCleansDirtyPages) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 32;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 2);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	std::vector<PageId> page_ids;
+	for (int i = 0; i < 10; ++i) {
+		PageId page_id;
+		bpm->NewPageGuarded(allocator, page_id);
+		page_ids.push_back(page_id);
+	}
+	ASSERT_EQ(bpm->GetNumDirtyPages(), 10);
+
+	// a latched page is skipped by the writer
+	auto latched = bpm->FetchPageWrite(page_ids[0]);
+	auto config = BackgroundWriterConfig {};
+	config.max_pages_per_round_ = 4;
+	// keep the writer thread asleep, rounds are driven by hand first
+	config.interval_ = std::chrono::hours(1);
+	auto writer = BackgroundWriter(*bpm, config);
+	ASSERT_EQ(writer.RunRound(), 4);
+	ASSERT_EQ(writer.RunRound(), 4);
+	ASSERT_EQ(writer.RunRound(), 1);
+	ASSERT_EQ(bpm->GetNumDirtyPages(), 1);
+	latched.Drop();
+	ASSERT_EQ(writer.RunRound(), 1);
+	ASSERT_EQ(bpm->GetNumDirtyPages(), 0);
+	writer.Stop();
+
+	// the writer thread picks up pages once they are dirtied
+	config.interval_ = std::chrono::milliseconds(1);
+	bpm->StartBackgroundWriter(config);
+	for (const auto &page_id : page_ids) {
+		std::ignore = bpm->FetchPageWrite(page_id).GetDataMut();
+	}
+	for (int i = 0; i < 1000 && bpm->GetNumDirtyPages() > 0; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_EQ(bpm->GetNumDirtyPages(), 0);
+}
+
+TEST(BufferPoolTest, BulkReadStrategyKeepsHotPages) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 64;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 2);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	std::vector<PageId> page_ids;
+	for (int i = 0; i < 128; ++i) {
+		PageId page_id;
+		bpm->NewPageGuarded(allocator, page_id);
+		page_ids.push_back(page_id);
+	}
+	bpm->FlushAllPages();
+	// start over with a cold pool, pages left resident by their creation would not go through the ring
+	bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 2);
+
+	// the hot set is touched twice so the pool would keep it over pages seen once
+	std::vector<PageId> hot_pages(page_ids.begin(), page_ids.begin() + 8);
+	for (int round = 0; round < 2; ++round) {
+		for (const auto &page_id : hot_pages) {
+			bpm->FetchPageRead(page_id);
+		}
+	}
+
+	auto strategy = bpm->MakeBulkReadStrategy();
+	for (auto it = page_ids.begin() + 8; it != page_ids.end(); ++it) {
+		bpm->FetchPageRead(*it, strategy.get());
+	}
+	for (const auto &page_id : hot_pages) {
+		ASSERT_TRUE(bpm->IsResident(page_id));
+	}
+	// lru-k keeps the hot set without a ring as well, the scan only stays out of the rest of the pool with one
+	auto scan_frames = std::count_if(page_ids.begin() + 8, page_ids.end(),
+	                                 [&](const PageId &page_id) { return bpm->IsResident(page_id); });
+	ASSERT_LE(scan_frames, BULK_READ_RING_SIZE);
+}
+
+TEST(BufferPoolTest, BulkReadStrategyRingPerShard) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const size_t num_shards = 16;
+	const frame_id_t buffer_pool_size = 32 * num_shards;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, num_shards);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	std::vector<PageId> page_ids;
+	for (int i = 0; i < 2 * buffer_pool_size; ++i) {
+		PageId page_id;
+		bpm->NewPageGuarded(allocator, page_id);
+		page_ids.push_back(page_id);
+	}
+	bpm->FlushAllPages();
+	bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, num_shards);
+
+	// an even split of the ring would leave 2 frames per shard
+	auto strategy = bpm->MakeBulkReadStrategy();
+	ASSERT_GE(strategy->GetShardRingSize(), READ_AHEAD_PAGES);
+	for (const auto &page_id : page_ids) {
+		bpm->FetchPageRead(page_id, strategy.get());
+	}
+	// every shard cycled the scan through its own ring and nothing else
+	size_t ring_frames = 0;
+	for (size_t i = 0; i < num_shards; ++i) {
+		const auto &ring = strategy->GetRing(i);
+		ASSERT_EQ(ring.slots_.size(), ring.capacity_);
+		for (const auto &slot : ring.slots_) {
+			ASSERT_TRUE(bpm->IsResident(slot.page_id_));
+		}
+		ring_frames += ring.capacity_;
+	}
+	auto scan_frames = std::count_if(page_ids.begin(), page_ids.end(),
+	                                 [&](const PageId &page_id) { return bpm->IsResident(page_id); });
+	ASSERT_EQ(scan_frames, ring_frames);
+	// the last pages of the scan survive however they hash, as a read-ahead window has to
+	for (auto it = page_ids.end() - READ_AHEAD_PAGES; it != page_ids.end(); ++it) {
+		ASSERT_TRUE(bpm->IsResident(*it));
+	}
+}
+
+TEST(BufferPoolTest, PrefetchPagesLoadsMisses) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 64;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 4);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	std::vector<PageId> page_ids;
+	for (int i = 0; i < 32; ++i) {
+		PageId page_id;
+		auto guard = bpm->NewPageGuarded(allocator, page_id);
+		std::memcpy(guard.GetDataMut(), &i, sizeof(i));
+		page_ids.push_back(page_id);
+	}
+	bpm->FlushAllPages();
+	// start over with a cold pool, but keep one page cached so the read-ahead has to split its reads around it
+	bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 4);
+	bpm->FetchPageRead(page_ids[10]);
+
+	bpm->PrefetchPages(page_ids[4], 16);
+	for (int i = 0; i < 32; ++i) {
+		ASSERT_EQ(bpm->IsResident(page_ids[i]), i >= 4 && i < 20);
+	}
+	for (int i = 4; i < 20; ++i) {
+		ASSERT_EQ(bpm->FetchPageRead(page_ids[i]).As<int>(), i);
+	}
+	// pages past the end of the file are skipped
+	bpm->PrefetchPages(page_ids[28], 8);
+	ASSERT_TRUE(bpm->IsResident(page_ids[31]));
+	ASSERT_FALSE(bpm->IsResident({page_ids[31].table_id_, page_ids[31].page_number_ + 1}));
+}
+
+TEST(BufferPoolTest, FetchPagesBatchesMisses) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 8;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 1);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	std::vector<PageId> page_ids;
+	for (int i = 0; i < 16; ++i) {
+		PageId page_id;
+		auto guard = bpm->NewPageGuarded(allocator, page_id);
+		std::memcpy(guard.GetDataMut(), &i, sizeof(i));
+		page_ids.push_back(page_id);
+	}
+	bpm->FlushAllPages();
+	bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 1);
+	bpm->FetchPageRead(page_ids[0]);
+	bpm->FetchPageRead(page_ids[1]);
+
+	// two cached pages, two runs of misses and a duplicate
+	std::vector<PageId> batch {page_ids[0], page_ids[1], page_ids[2], page_ids[3], page_ids[4],
+	                           page_ids[6], page_ids[7], page_ids[3]};
+	auto guards = bpm->FetchPages(batch);
+	ASSERT_EQ(guards.size(), batch.size());
+	for (size_t i = 0; i < batch.size(); ++i) {
+		ASSERT_EQ(guards[i].PageId(), batch[i].page_number_);
+		ASSERT_EQ(guards[i].As<int>(), static_cast<int>(batch[i].page_number_ - page_ids[0].page_number_));
+	}
+	auto metrics = bpm->GetMetrics();
+	ASSERT_EQ(metrics.hits_, 3);
+	ASSERT_EQ(metrics.misses_, 7);
+	ASSERT_EQ(metrics.read_latency_.count_, 4);
+
+	// the guards keep seven frames pinned, only one is left
+	auto last_frame = bpm->FetchPageRead(page_ids[10]);
+	ASSERT_THROW(bpm->FetchPageRead(page_ids[11]), std::runtime_error);
+	guards.clear();
+	ASSERT_EQ(bpm->FetchPageRead(page_ids[11]).As<int>(), 11);
+}
+
+TEST(BufferPoolTest, FetchPagesUnpinsOnFailedRead) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 8;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 1);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	std::vector<PageId> page_ids;
+	for (int i = 0; i < 16; ++i) {
+		PageId page_id;
+		bpm->NewPageGuarded(allocator, page_id);
+		page_ids.push_back(page_id);
+	}
+	bpm->FlushAllPages();
+	bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 1);
+
+	// the page past the end of the file fails after the other three were read in
+	PageId missing_page_id {page_ids[0].table_id_, page_ids[0].page_number_ + 100};
+	std::vector<PageId> batch {missing_page_id, page_ids[2], page_ids[3], page_ids[4]};
+	ASSERT_THROW(bpm->FetchPages(batch), IOException);
+
+	// none of the frames stayed pinned
+	std::vector<ReadPageGuard> guards;
+	for (int i = 8; i < 16; ++i) {
+		guards.push_back(bpm->FetchPageRead(page_ids[i]));
+	}
+}
+
+TEST(BufferPoolTest, FramesLiveInAlignedArena) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 64;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	for (bool use_huge_pages : {false, true}) {
+		auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 4, 0, use_huge_pages);
+		const auto &arena = bpm->GetFrameArena();
+		auto *arena_begin = arena.GetFrame(0);
+		auto *arena_end = arena.GetFrame(arena.GetNumFrames());
+		for (int i = 0; i < buffer_pool_size; ++i) {
+			PageId page_id;
+			auto guard = bpm->NewPageGuarded(allocator, page_id);
+			const auto *data = guard.GetData();
+			ASSERT_EQ(reinterpret_cast<uintptr_t>(data) % PAGE_SIZE, 0);
+			ASSERT_TRUE(data >= arena_begin && data < arena_end);
+		}
+	}
+}
+
+TEST(BufferPoolTest, ResizeWhileInUse) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const int num_pages = 96;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(16, *dm, ReplacerType::LRU_K, 4, 256);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	std::vector<PageId> page_ids;
+	for (int i = 0; i < num_pages; ++i) {
+		PageId page_id;
+		auto guard = bpm->NewPageGuarded(allocator, page_id);
+		std::memcpy(guard.GetDataMut(), &i, sizeof(i));
+		page_ids.push_back(page_id);
+	}
+	bpm->Resize(256);
+	ASSERT_EQ(bpm->GetPoolSize(), 256);
+	for (int i = 0; i < num_pages; ++i) {
+		ASSERT_EQ(bpm->FetchPageRead(page_ids[i]).As<int>(), i);
+	}
+	// every page fits now, nothing gets evicted
+	for (const auto &page_id : page_ids) {
+		ASSERT_TRUE(bpm->IsResident(page_id));
+	}
+
+	// readers and writers keep going while the pool shrinks and grows under them
+	std::atomic<bool> stop {false};
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&, t] {
+			std::mt19937 gen(t);
+			std::uniform_int_distribution<> dist(0, num_pages - 1);
+			while (!stop) {
+				auto i = dist(gen);
+				if (t == 0) {
+					auto guard = bpm->FetchPageWrite(page_ids[i]);
+					std::memcpy(guard.GetDataMut(), &i, sizeof(i));
+				} else {
+					ASSERT_EQ(bpm->FetchPageRead(page_ids[i]).As<int>(), i);
+				}
+			}
+		});
+	}
+	for (frame_id_t pool_size : {32, 128, 20, 200, 24}) {
+		bpm->Resize(pool_size);
+		ASSERT_EQ(bpm->GetPoolSize(), pool_size);
+	}
+	stop = true;
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	ASSERT_THROW(bpm->Resize(512), RuntimeException);
+	for (int i = 0; i < num_pages; ++i) {
+		ASSERT_EQ(bpm->FetchPageRead(page_ids[i]).As<int>(), i);
+	}
+}
+
+TEST(BufferPoolTest, ShrinkKeepsPinnedFrames) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 32;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 1);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	// every frame stays pinned, the shrink gives up after the timeout instead of waiting for them
+	std::vector<BasicPageGuard> guards;
+	for (int i = 0; i < buffer_pool_size; ++i) {
+		PageId page_id;
+		guards.push_back(bpm->NewPageGuarded(allocator, page_id));
+	}
+	ASSERT_EQ(bpm->Resize(16, std::chrono::milliseconds(10)), buffer_pool_size);
+	ASSERT_EQ(bpm->GetPoolSize(), buffer_pool_size);
+	guards.clear();
+	ASSERT_EQ(bpm->Resize(16), 16);
+	ASSERT_EQ(bpm->GetPoolSize(), 16);
+}
+
+TEST(BufferPoolTest, WarmRestartReloadsHotPages) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 32;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 1);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	std::vector<PageId> page_ids;
+	for (int i = 0; i < 128; ++i) {
+		PageId page_id;
+		auto guard = bpm->NewPageGuarded(allocator, page_id);
+		std::memcpy(guard.GetDataMut(), &i, sizeof(i));
+		page_ids.push_back(page_id);
+	}
+	// every eighth page is hot, the other cached pages were only touched once
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < 128; i += 8) {
+			bpm->FetchPageRead(page_ids[i]);
+		}
+	}
+	bpm->FlushAllPages();
+	auto dump_path = FilePathManager::GetInstance().GetBufferPoolDumpPath();
+	bpm->SaveResidentPages(dump_path);
+
+	// a smaller pool only gets the hot pages back
+	bpm = std::make_unique<BufferPool>(buffer_pool_size / 2, *dm, ReplacerType::LRU_K, 1);
+	ASSERT_EQ(bpm->LoadResidentPages(dump_path), buffer_pool_size / 2);
+	for (int i = 0; i < 128; ++i) {
+		ASSERT_EQ(bpm->IsResident(page_ids[i]), i % 8 == 0);
+	}
+	ASSERT_EQ(bpm->FetchPageRead(page_ids[64]).As<int>(), 64);
+	ASSERT_EQ(bpm->LoadResidentPages(FilePathManager::GetInstance().GetDatabaseRootPath() / "missing"), 0);
+}
+
+TEST(BufferPoolTest, MetricsCountHitsMissesAndEvictions) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 8;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, 1);
+	auto &table = CreateTestTable(*cm);
+	auto allocator = TestPageAllocator(table);
+
+	// the last 8 of 16 new pages stay cached, the first 8 were evicted dirty
+	std::vector<PageId> page_ids;
+	for (int i = 0; i < 16; ++i) {
+		PageId page_id;
+		bpm->NewPageGuarded(allocator, page_id);
+		page_ids.push_back(page_id);
+	}
+	auto metrics = bpm->GetMetrics();
+	ASSERT_EQ(metrics.dirty_evictions_, 8);
+	ASSERT_EQ(metrics.write_latency_.count_, 8);
+
+	for (int i = 8; i < 16; ++i) {
+		bpm->FetchPageRead(page_ids[i]);
+	}
+	for (int i = 0; i < 4; ++i) {
+		bpm->FetchPageRead(page_ids[i]);
+	}
+	ASSERT_TRUE(bpm->FlushPage(page_ids[3]));
+	metrics = bpm->GetMetrics();
+	ASSERT_EQ(metrics.hits_, 8);
+	ASSERT_EQ(metrics.misses_, 4);
+	ASSERT_EQ(metrics.read_latency_.count_, 4);
+	ASSERT_EQ(metrics.dirty_evictions_ + metrics.clean_evictions_, 12);
+	ASSERT_EQ(metrics.flushes_, 1);
+	ASSERT_DOUBLE_EQ(metrics.GetHitRatio(), 8.0 / 12);
+	const auto &table_metrics = metrics.tables_.at(table.table_oid_);
+	ASSERT_EQ(table_metrics.hits_, 8);
+	ASSERT_EQ(table_metrics.misses_, 4);
+	ASSERT_EQ(table_metrics.evictions_, 12);
+	auto summary = metrics.ToString();
+	ASSERT_NE(summary.find("hits=8,"), std::string::npos);
+	ASSERT_NE(summary.find("misses=4,"), std::string::npos);
+	ASSERT_NE(summary.find("hit_ratio=0.667,"), std::string::npos);
+	ASSERT_NE(summary.find("flushes=1,"), std::string::npos);
+
+	// tables are broken down whatever their oid, the system catalog included
+	BufferPoolMetrics table_counters;
+	table_counters.RecordHit({100000, 0});
+	table_counters.RecordMiss({3, 0});
+	table_counters.RecordMiss({SYSTEM_CATALOG_ID, 0});
+	table_counters.RecordHit({-2, 0});
+	auto table_snapshot = table_counters.Snapshot();
+	ASSERT_EQ(table_snapshot.tables_.at(100000).hits_, 1);
+	ASSERT_EQ(table_snapshot.tables_.at(3).misses_, 1);
+	ASSERT_EQ(table_snapshot.tables_.at(SYSTEM_CATALOG_ID).misses_, 1);
+	ASSERT_EQ(table_snapshot.tables_.size(), 3);
+	ASSERT_EQ(table_snapshot.hits_, 2);
+}
+
+TEST(BufferPoolTest, NamedPoolsKeepScansAwayFromIndexes) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto buffer_pools = BufferPoolSet(*dm, {DEFAULT_BUFFER_POOL, 16});
+	auto &index_pool = buffer_pools.AddPool({INDEX_BUFFER_POOL, 16});
+	ASSERT_THROW(buffer_pools.AddPool({INDEX_BUFFER_POOL, 16}), RuntimeException);
+	// no heap pool is configured, heap pages go to the default pool
+	auto &table = CreateTestTable(*cm);
+	ASSERT_EQ(table.buffer_pool_, HEAP_BUFFER_POOL);
+	auto &heap_pool = buffer_pools.GetPool(table.buffer_pool_);
+	ASSERT_EQ(&heap_pool, &buffer_pools.GetDefaultPool());
+	ASSERT_EQ(&buffer_pools.GetPool(INDEX_BUFFER_POOL), &index_pool);
+	ASSERT_EQ(&buffer_pools.GetExistingPool(INDEX_BUFFER_POOL), &index_pool);
+	ASSERT_THROW(buffer_pools.GetExistingPool(HEAP_BUFFER_POOL), RuntimeException);
+	auto allocator = TestPageAllocator(table);
+
+	std::vector<PageId> index_pages;
+	for (int i = 0; i < 8; ++i) {
+		PageId page_id;
+		index_pool.NewPageGuarded(allocator, page_id);
+		index_pages.push_back(page_id);
+	}
+	// a scan over many more heap pages than either pool holds
+	for (int i = 0; i < 64; ++i) {
+		PageId page_id;
+		heap_pool.NewPageGuarded(allocator, page_id);
+	}
+	for (const auto &page_id : index_pages) {
+		ASSERT_TRUE(index_pool.IsResident(page_id));
+	}
+	ASSERT_EQ(index_pool.GetMetrics().dirty_evictions_, 0);
+	ASSERT_GT(heap_pool.GetMetrics().dirty_evictions_, 0);
+}
+
+// throughput of concurrent hits with one shard versus several, run it with --gtest_also_run_disabled_tests
+TEST(BufferPoolTest, DISABLED_ShardedFetchScaling) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	const frame_id_t buffer_pool_size = 512;
+	const int num_pages = 256;
+	const int fetches_per_thread = 100000;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto allocator = TestPageAllocator(CreateTestTable(*cm));
+
+	for (uint32_t num_shards : {1U, 16U}) {
+		auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, num_shards);
+		std::vector<PageId> page_ids;
+		for (int i = 0; i < num_pages; ++i) {
+			PageId page_id;
+			bpm->NewPageGuarded(allocator, page_id);
+			page_ids.push_back(page_id);
+		}
+
+		for (uint32_t num_threads = 1; num_threads <= 8; num_threads *= 2) {
+			std::vector<std::thread> threads;
+			auto start = std::chrono::steady_clock::now();
+			for (uint32_t t = 0; t < num_threads; ++t) {
+				threads.emplace_back([&, t] {
+					std::mt19937 gen(t);
+					std::uniform_int_distribution<> dist(0, num_pages - 1);
+					for (int i = 0; i < fetches_per_thread; ++i) {
+						auto guard = bpm->FetchPageRead(page_ids[dist(gen)]);
+					}
+				});
+			}
+			for (auto &thread : threads) {
+				thread.join();
+			}
+			auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			auto throughput = static_cast<double>(num_threads) * fetches_per_thread / elapsed;
+			LOG_INFO("shards: {} threads: {} fetches/s: {:.0f}", num_shards, num_threads, throughput);
+		}
+	}
+}
+
+} // namespace db
@@ -0,0 +1,400 @@
+#include "common/exception.hpp"
+#include "common/fs_utils.hpp"
+#include "common/test_utils.hpp"
+#include "meta/catalog.hpp"
+#include "storage/disk_manager.hpp"
+#include "storage/file_path_manager.hpp"
+
+#include "gtest/gtest.h"
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace db {
+
+TEST(DiskManagerTest, ConcurrentIoOnOneFile) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto table_oid = CreateTestTable(*cm).table_oid_;
+
+	// every thread owns the pages page_number % num_threads == t of the same file and checks what it wrote
+	constexpr int num_threads = 4;
+	constexpr int num_pages = 64;
+	std::vector<std::thread> threads;
+	std::atomic<bool> all_match = true;
+	for (int t = 0; t < num_threads; ++t) {
+		threads.emplace_back([&, t] {
+			std::array<char, PAGE_SIZE> data;
+			std::array<char, PAGE_SIZE> read_back;
+			for (int round = 0; round < 8; ++round) {
+				for (int i = t; i < num_pages; i += num_threads) {
+					data.fill(static_cast<char>(i + round));
+					dm->WritePage({table_oid, i}, data.data());
+				}
+				for (int i = t; i < num_pages; i += num_threads) {
+					dm->ReadPage({table_oid, i}, read_back.data());
+					if (read_back[0] != static_cast<char>(i + round) || read_back[PAGE_SIZE - 1] != read_back[0]) {
+						all_match = false;
+					}
+				}
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	ASSERT_TRUE(all_match);
+}
+
+TEST(DiskManagerTest, BatchedReads) {
+	for (auto io_engine : {IoEngineType::SYNC, IoEngineType::IO_URING}) {
+		DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+		auto cm = std::make_unique<Catalog>();
+		// io_uring falls back to blocking io where liburing or the kernel support is missing
+		auto dm = std::make_unique<DiskManager>(*cm, DiskManagerConfig {.io_engine_ = io_engine});
+		auto table_oid = CreateTestTable(*cm).table_oid_;
+		constexpr int num_pages = 16;
+		std::array<char, PAGE_SIZE> data;
+		for (int i = 0; i < num_pages; ++i) {
+			data.fill(static_cast<char>(i));
+			dm->WritePage({table_oid, i}, data.data());
+		}
+
+		// the second run goes past the end of the file and returns the pages that exist
+		std::vector<std::array<char, PAGE_SIZE>> pages(12);
+		std::vector<char *> frames;
+		for (auto &page : pages) {
+			frames.push_back(page.data());
+		}
+		std::vector<PageRun> runs {{{table_oid, 2}, std::span<char *const>(frames).subspan(0, 4)},
+		                           {{table_oid, num_pages - 3}, std::span<char *const>(frames).subspan(4, 8)}};
+		dm->ReadPageRuns(runs);
+		ASSERT_EQ(runs[0].num_read_, 4);
+		ASSERT_EQ(runs[1].num_read_, 3);
+		for (int i = 0; i < 4; ++i) {
+			ASSERT_EQ(pages[i][0], static_cast<char>(2 + i));
+			ASSERT_EQ(pages[i][PAGE_SIZE - 1], static_cast<char>(2 + i));
+		}
+		for (int i = 0; i < 3; ++i) {
+			ASSERT_EQ(pages[4 + i][0], static_cast<char>(num_pages - 3 + i));
+		}
+
+		// a run longer than IOV_MAX pages is read in parts
+		std::vector<std::array<char, PAGE_SIZE>> long_pages(IOV_MAX + 4);
+		std::vector<PageWrite> writes;
+		for (size_t i = 0; i < long_pages.size(); ++i) {
+			long_pages[i].fill(static_cast<char>(i));
+			writes.push_back({{table_oid, static_cast<page_id_t>(i)}, long_pages[i].data()});
+		}
+		dm->WritePages(writes, false);
+		frames.clear();
+		for (auto &page : long_pages) {
+			page.fill(-1);
+			frames.push_back(page.data());
+		}
+		std::vector<PageRun> long_runs {{{table_oid, 0}, frames}};
+		dm->ReadPageRuns(long_runs);
+		ASSERT_EQ(long_runs[0].num_read_, long_pages.size());
+		for (size_t i = 0; i < long_pages.size(); ++i) {
+			ASSERT_EQ(long_pages[i][PAGE_SIZE - 1], static_cast<char>(i));
+		}
+	}
+}
+
+TEST(DiskManagerTest, ReadsAreCheckedAgainstTheCachedFileSize) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto table_oid = CreateTestTable(*cm).table_oid_;
+	std::array<char, PAGE_SIZE> data;
+	ASSERT_THROW(dm->ReadPage({table_oid, 1}, data.data()), IOException);
+
+	data.fill('x');
+	dm->WritePage({table_oid, 3}, data.data());
+	data.fill(0);
+	dm->ReadPage({table_oid, 3}, data.data());
+	ASSERT_EQ(data[PAGE_SIZE - 1], 'x');
+	// the page at the end of the file reads as zeros and extends the file by a page without writing it
+	auto before = dm->GetIoStats();
+	data.fill('x');
+	dm->ReadPage({table_oid, 4}, data.data());
+	ASSERT_EQ(data[0], 0);
+	data.fill('x');
+	dm->ReadPage({table_oid, 5}, data.data());
+	ASSERT_EQ(data[PAGE_SIZE - 1], 0);
+	ASSERT_EQ(dm->GetIoStats().write_requests_, before.write_requests_);
+	ASSERT_THROW(dm->ReadPage({table_oid, 7}, data.data()), IOException);
+}
+
+TEST(DiskManagerTest, BatchedWritesAndSync) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto table_oid = CreateTestTable(*cm).table_oid_;
+
+	// out of order with a gap, the writes are sorted and merged into two runs
+	constexpr int num_pages = 8;
+	std::vector<std::array<char, PAGE_SIZE>> pages(num_pages);
+	std::vector<PageWrite> writes;
+	for (int i = num_pages - 1; i >= 0; --i) {
+		pages[i].fill(static_cast<char>('a' + i));
+		if (i != 5) {
+			writes.push_back({{table_oid, i}, pages[i].data()});
+		}
+	}
+	auto before = dm->GetIoStats();
+	dm->WritePages(writes, true);
+	auto after = dm->GetIoStats();
+	ASSERT_EQ(after.write_requests_ - before.write_requests_, 2U);
+	ASSERT_EQ(after.syncs_ - before.syncs_, 1U);
+	ASSERT_EQ(after.unsynced_files_, 0U);
+	// nothing was written since the synced batch
+	dm->Sync();
+	ASSERT_EQ(dm->GetIoStats().syncs_, after.syncs_);
+
+	std::array<char, PAGE_SIZE> data;
+	for (int i = 0; i < num_pages; ++i) {
+		dm->ReadPage({table_oid, i}, data.data());
+		ASSERT_EQ(data[0], i == 5 ? 0 : static_cast<char>('a' + i));
+		ASSERT_EQ(data[PAGE_SIZE - 1], i == 5 ? 0 : static_cast<char>('a' + i));
+	}
+	dm->WritePage({table_oid, 5}, pages[5].data());
+	ASSERT_EQ(dm->GetIoStats().unsynced_files_, 1U);
+	dm->Sync();
+	ASSERT_EQ(dm->GetIoStats().unsynced_files_, 0U);
+	ASSERT_EQ(dm->GetIoStats().syncs_, after.syncs_ + 1);
+}
+
+TEST(DiskManagerTest, FilesGrowInPreallocatedExtents) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>();
+	constexpr size_t extent_size = 256 * PAGE_SIZE;
+	auto dm = std::make_unique<DiskManager>(*cm, DiskManagerConfig {.extent_size_ = extent_size});
+	auto table_oid = CreateTestTable(*cm).table_oid_;
+	std::array<char, PAGE_SIZE> data;
+	data.fill('x');
+	dm->WritePage({table_oid, 0}, data.data());
+	dm->WritePage({table_oid, 1}, data.data());
+	auto path = FilePathManager::GetInstance().GetTableDataPath(cm->GetTableName(table_oid));
+	// a file system without fallocate grows the file with its writes
+	auto probe_path = path.parent_path() / "fallocate_probe";
+	auto probe_fd = open(probe_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	ASSERT_GE(probe_fd, 0);
+	auto can_preallocate = fallocate(probe_fd, FALLOC_FL_KEEP_SIZE, 0, PAGE_SIZE) == 0;
+	close(probe_fd);
+	std::filesystem::remove(probe_path);
+	if (!can_preallocate) {
+		GTEST_SKIP() << "the file system does not support fallocate";
+	}
+
+	// the first write reserved a whole extent, the file size still ends at the last page written
+	struct stat stat_buf;
+	ASSERT_EQ(stat(path.c_str(), &stat_buf), 0);
+	ASSERT_EQ(stat_buf.st_size, 2 * PAGE_SIZE);
+	ASSERT_GE(static_cast<size_t>(stat_buf.st_blocks) * 512, extent_size);
+	ASSERT_THROW(dm->ReadPage({table_oid, 3}, data.data()), IOException);
+	dm->ReadPage({table_oid, 1}, data.data());
+	ASSERT_EQ(data[0], 'x');
+}
+
+TEST(DiskManagerTest, TablespaceKeepsAllTablesInOneFile) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>(StorageLayout::TABLESPACE);
+	auto config = DiskManagerConfig {.layout_ = StorageLayout::TABLESPACE};
+	auto dm = std::make_unique<DiskManager>(*cm, config);
+	auto first_oid = CreateTestTable(*cm).table_oid_;
+	auto second_oid = CreateTestTable(*cm, "second_test_table").table_oid_;
+	ASSERT_FALSE(std::filesystem::exists(FilePathManager::GetInstance().GetTableDataPath("test_table")));
+
+	// the extents of the two tables interleave in the file, the batch crosses an extent boundary of both
+	constexpr int num_pages = TABLESPACE_EXTENT_PAGES + 8;
+	std::vector<std::array<char, PAGE_SIZE>> pages(2 * num_pages);
+	std::vector<PageWrite> writes;
+	for (int i = 0; i < num_pages; ++i) {
+		pages[i].fill(static_cast<char>(i));
+		pages[num_pages + i].fill(static_cast<char>(i + 1));
+		writes.push_back({{first_oid, i}, pages[i].data()});
+		writes.push_back({{second_oid, i}, pages[num_pages + i].data()});
+	}
+	dm->WritePages(writes, true);
+	dm.reset();
+
+	dm = std::make_unique<DiskManager>(*cm, config);
+	std::array<char, PAGE_SIZE> data;
+	dm->ReadPage({second_oid, 0}, data.data());
+	ASSERT_EQ(data[0], 1);
+	std::vector<std::array<char, PAGE_SIZE>> read_back(16);
+	std::vector<char *> frames;
+	for (auto &page : read_back) {
+		frames.push_back(page.data());
+	}
+	std::vector<PageRun> runs {{{first_oid, TABLESPACE_EXTENT_PAGES - 8}, std::span<char *const>(frames)}};
+	dm->ReadPageRuns(runs);
+	ASSERT_EQ(runs[0].num_read_, 16);
+	for (int i = 0; i < 16; ++i) {
+		ASSERT_EQ(read_back[i][PAGE_SIZE - 1], static_cast<char>(TABLESPACE_EXTENT_PAGES - 8 + i));
+	}
+	// the tables end at their last written page rather than at the end of their last extent
+	ASSERT_THROW(dm->ReadPage({first_oid, num_pages + 1}, data.data()), IOException);
+	runs = {{{second_oid, num_pages - 4}, std::span<char *const>(frames).subspan(0, 8)}};
+	dm->ReadPageRuns(runs);
+	ASSERT_EQ(runs[0].num_read_, 4);
+}
+
+TEST(DiskManagerTest, FailedRequestKeepsThePagesOfItsRunReadBefore) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>(StorageLayout::TABLESPACE);
+	auto config = DiskManagerConfig {.layout_ = StorageLayout::TABLESPACE};
+	auto dm = std::make_unique<DiskManager>(*cm, config);
+	auto table_oid = CreateTestTable(*cm).table_oid_;
+	constexpr int num_pages = TABLESPACE_EXTENT_PAGES + 8;
+	std::vector<std::array<char, PAGE_SIZE>> pages(num_pages);
+	std::vector<PageWrite> writes;
+	for (int i = 0; i < num_pages; ++i) {
+		pages[i].fill(static_cast<char>(i));
+		writes.push_back({{table_oid, i}, pages[i].data()});
+	}
+	dm->WritePages(writes, true);
+
+	// the run crosses an extent boundary and is read with two requests. the second one reads into memory the kernel
+	// cannot write to and fails with EFAULT
+	constexpr size_t num_unwritable = 8;
+	auto *unwritable = static_cast<char *>(
+	    mmap(nullptr, num_unwritable * PAGE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	ASSERT_NE(unwritable, MAP_FAILED);
+	std::vector<std::array<char, PAGE_SIZE>> read_back(8);
+	std::vector<char *> frames;
+	for (auto &page : read_back) {
+		frames.push_back(page.data());
+	}
+	for (size_t i = 0; i < num_unwritable; ++i) {
+		frames.push_back(unwritable + i * PAGE_SIZE);
+	}
+	std::vector<PageRun> runs {{{table_oid, TABLESPACE_EXTENT_PAGES - 8}, std::span<char *const>(frames)}};
+	dm->ReadPageRuns(runs);
+	munmap(unwritable, num_unwritable * PAGE_SIZE);
+	ASSERT_EQ(runs[0].num_read_, 8);
+	for (int i = 0; i < 8; ++i) {
+		ASSERT_EQ(read_back[i][PAGE_SIZE - 1], static_cast<char>(TABLESPACE_EXTENT_PAGES - 8 + i));
+	}
+}
+
+TEST(DiskManagerTest, TablespaceDirectoryKeepsSizesAndChecksItsHeader) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>(StorageLayout::TABLESPACE);
+	auto config = DiskManagerConfig {.layout_ = StorageLayout::TABLESPACE};
+	auto dm = std::make_unique<DiskManager>(*cm, config);
+	auto table_oid = CreateTestTable(*cm).table_oid_;
+	std::array<char, PAGE_SIZE> data;
+	data.fill('x');
+	dm->WritePage({table_oid, 0}, data.data());
+	dm->Sync();
+	// grown after the last sync, the size is written when the tablespace is closed
+	dm->WritePage({table_oid, 1}, data.data());
+	dm->WritePage({table_oid, 2}, data.data());
+	dm.reset();
+
+	dm = std::make_unique<DiskManager>(*cm, config);
+	dm->ReadPage({table_oid, 2}, data.data());
+	ASSERT_EQ(data[0], 'x');
+	ASSERT_THROW(dm->ReadPage({table_oid, 4}, data.data()), IOException);
+	dm.reset();
+
+	// a directory without the expected header is refused rather than read as entries
+	auto fd = open(FilePathManager::GetInstance().GetTablespaceDirectoryPath().c_str(), O_WRONLY);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(pwrite(fd, "XXXX", 4, 0), 4);
+	close(fd);
+	ASSERT_THROW(DiskManager(*cm, config), IOException);
+}
+
+TEST(DiskManagerTest, OpenFilesAreBounded) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm, DiskManagerConfig {.max_open_files_ = 2});
+	std::vector<table_oid_t> table_oids;
+	for (int i = 0; i < 4; ++i) {
+		table_oids.push_back(CreateTestTable(*cm, "bounded_" + std::to_string(i)).table_oid_);
+	}
+	std::array<char, PAGE_SIZE> data;
+	for (auto table_oid : table_oids) {
+		data.fill(static_cast<char>(table_oid));
+		dm->WritePage({table_oid, 0}, data.data());
+		dm->WritePage({table_oid, 1}, data.data());
+	}
+	auto stats = dm->GetFileCacheStats();
+	ASSERT_EQ(stats.open_files_, 2);
+	ASSERT_EQ(stats.misses_, 4);
+	ASSERT_EQ(stats.hits_, 4);
+
+	// the least recently used file without users is the one closed
+	dm->ReadPage({table_oids[2], 1}, data.data());
+	dm->ReadPage({table_oids[0], 1}, data.data());
+	dm->ReadPage({table_oids[2], 1}, data.data());
+	ASSERT_EQ(dm->GetFileCacheStats().hits_, stats.hits_ + 2);
+	ASSERT_EQ(dm->GetFileCacheStats().misses_, stats.misses_ + 1);
+
+	// the closed files are reopened with their size and their writes intact
+	for (auto table_oid : table_oids) {
+		dm->ReadPage({table_oid, 1}, data.data());
+		ASSERT_EQ(data[0], static_cast<char>(table_oid));
+		ASSERT_THROW(dm->ReadPage({table_oid, 3}, data.data()), IOException);
+	}
+	dm->Sync();
+	ASSERT_LE(dm->GetFileCacheStats().open_files_, 2);
+}
+
+TEST(DiskManagerTest, DirectIoWithUnalignedBuffers) {
+	DeletePathIfExists(FilePathManager::GetInstance().GetDatabaseRootPath());
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm, DiskManagerConfig {.direct_io_ = true});
+	auto table_oid = CreateTestTable(*cm).table_oid_;
+	// a file system without o_direct support falls back to the os page cache
+	auto path = FilePathManager::GetInstance().GetTableDataPath(cm->GetTableName(table_oid));
+	auto probe_path = path.parent_path() / "direct_io_probe";
+	auto probe_fd = open(probe_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_DIRECT, 0644);
+	if (probe_fd < 0) {
+		GTEST_SKIP() << "the file system does not support o_direct: " << std::strerror(errno);
+	}
+	close(probe_fd);
+	std::filesystem::remove(probe_path);
+	ASSERT_GT(dm->GetIoAlignment(table_oid), 0U);
+
+	// one byte into the array, so no buffer is aligned for direct io and every transfer goes through a copy
+	constexpr int num_pages = 4;
+	std::vector<std::array<char, PAGE_SIZE + 1>> pages(num_pages);
+	std::vector<PageWrite> writes;
+	for (int i = 0; i < num_pages; ++i) {
+		std::memset(pages[i].data() + 1, 'a' + i, PAGE_SIZE);
+		writes.push_back({{table_oid, i}, pages[i].data() + 1});
+	}
+	dm->WritePage({table_oid, 0}, pages[0].data() + 1);
+	dm->WritePages(std::span<const PageWrite>(writes).subspan(1), true);
+
+	std::array<char, PAGE_SIZE + 1> data;
+	dm->ReadPage({table_oid, 3}, data.data() + 1);
+	ASSERT_EQ(data[PAGE_SIZE], 'd');
+	std::vector<std::array<char, PAGE_SIZE + 1>> read_back(num_pages);
+	std::vector<char *> frames;
+	for (auto &page : read_back) {
+		frames.push_back(page.data() + 1);
+	}
+	std::vector<PageRun> runs {{{table_oid, 0}, std::span<char *const>(frames)}};
+	dm->ReadPageRuns(runs);
+	ASSERT_EQ(runs[0].num_read_, num_pages);
+	for (int i = 0; i < num_pages; ++i) {
+		ASSERT_EQ(read_back[i][1], static_cast<char>('a' + i));
+		ASSERT_EQ(read_back[i][PAGE_SIZE], static_cast<char>('a' + i));
+	}
+}
+} // namespace db
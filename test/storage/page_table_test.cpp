@@ -0,0 +1,43 @@
+#include "storage/buffer/page_table.hpp"
+
+#include "gtest/gtest.h"
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace db {
+
+TEST(PageTableTest, HashSpreadsTablesAndPages) {
+	// the old hash shifted table ids into the page number bits, page 1 << 31 of table 0 met page 0 of table 1
+	ASSERT_NE(PageIdHash {}({0, INT32_MIN}), PageIdHash {}({1, 0}));
+	ASSERT_NE(PageIdHash {}({SYSTEM_CATALOG_ID, 0}), PageIdHash {}({0, 0}));
+}
+
+TEST(PageTableTest, InsertFindErase) {
+	const size_t num_frames = 64;
+	auto page_table = PageTable(num_frames);
+	std::unordered_map<uint64_t, frame_id_t> expected;
+	std::vector<PageId> cached;
+	std::mt19937 gen(42);
+
+	// keep the table full and churn through many pages of a few tables so erases have to shift probe chains
+	for (int i = 0; i < 20000; ++i) {
+		if (cached.size() == num_frames) {
+			auto victim = std::uniform_int_distribution<size_t>(0, cached.size() - 1)(gen);
+			ASSERT_TRUE(page_table.Erase(cached[victim]));
+			expected.erase(cached[victim].Pack());
+			cached[victim] = cached.back();
+			cached.pop_back();
+		}
+		PageId page_id {static_cast<table_oid_t>(i % 3), i};
+		page_table.Insert(page_id, i % static_cast<frame_id_t>(num_frames));
+		expected[page_id.Pack()] = i % static_cast<frame_id_t>(num_frames);
+		cached.push_back(page_id);
+	}
+	for (const auto &page_id : cached) {
+		ASSERT_EQ(page_table.Find(page_id), expected[page_id.Pack()]);
+	}
+	ASSERT_EQ(page_table.Find({0, 0}), INVALID_FRAME_ID);
+	ASSERT_FALSE(page_table.Erase({0, 0}));
+}
+} // namespace db
@@ -102,4 +102,39 @@ TEST(StorageTest, TableHeapManyInsertionTest) {
 		ASSERT_EQ(tuple.ToString(schema), ans[i]);
 	}
 }
+TEST(StorageTest, TableHeapScanReadsAheadIntoRing) {
+	DeletePathIfExists(db::FilePathManager::GetInstance().GetDatabaseRootPath());
+	const size_t num_shards = 8;
+	const size_t buffer_pool_size = 32 * num_shards;
+	auto cm = std::make_unique<Catalog>();
+	auto dm = std::make_unique<DiskManager>(*cm);
+	auto bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, num_shards);
+
+	auto schema = Schema({Column("user_id", db::TypeId::INTEGER), Column("user_name", db::TypeId::VARCHAR, 1024)});
+	cm->CreateTable("user", schema);
+	auto &table_meta = cm->GetTableByName("user");
+	auto table_heap = std::make_unique<TableHeap>(*bpm, table_meta);
+	// a few tuples per page, the table ends up several times the size of the pool
+	for (int i = 0; i < 4000; ++i) {
+		auto tuple = Tuple({Value(db::TypeId::INTEGER, i), Value(db::TypeId::VARCHAR, std::string(1000, 'x'))}, schema);
+		ASSERT_TRUE(table_heap->InsertTuple(TupleMeta {false}, tuple).has_value());
+	}
+	auto num_pages = static_cast<uint64_t>(table_meta.GetLastTableHeapDataPageId());
+	ASSERT_GT(num_pages, 2 * buffer_pool_size);
+	bpm->FlushAllPages();
+
+	// scan with a cold pool, the scan is large enough to get a ring
+	bpm = std::make_unique<BufferPool>(buffer_pool_size, *dm, ReplacerType::LRU_K, num_shards);
+	table_heap = std::make_unique<TableHeap>(*bpm, table_meta);
+	auto it = table_heap->MakeIterator();
+	while (!it.IsEnd()) {
+		ASSERT_TRUE(it.GetTuple().has_value());
+		++it;
+	}
+	// the scan covers pages [1, num_pages] and reads every page once, the pages read ahead are still in their ring when
+	// the cursor fetches them
+	auto metrics = bpm->GetMetrics();
+	ASSERT_EQ(metrics.misses_ + metrics.prefetched_pages_, num_pages);
+	ASSERT_LE(metrics.misses_, 2);
+}
 } // namespace db